@@ -102,6 +102,15 @@ class CGradientValueData : public ICustomConfigValueData {
     /* Whether this gradient stores a fallback value (not exlicitly set) */
     bool m_bIsFallback = false;
 
+    /* Set by gradient animations. The shader blends from this gradient (OkLabA, angle) to the one above by m_fLerp */
+    std::vector<float> m_vLerpFromOkLabA;
+    float              m_fLerpFromAngle = 0;
+    float              m_fLerp          = 1;
+
+    bool               isLerping() const {
+        return m_fLerp < 1 && !m_vLerpFromOkLabA.empty();
+    }
+
     //
     bool operator==(const CGradientValueData& other) const {
         if (other.m_vColors.size() != m_vColors.size() || m_fAngle != other.m_fAngle)
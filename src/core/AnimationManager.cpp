@@ -2,6 +2,7 @@
 #include "../helpers/AnimatedVariable.hpp"
 #include "../config/ConfigDataValues.hpp"
 #include "../config/ConfigManager.hpp"
+#include <algorithm>
 
 CHyprlockAnimationManager::CHyprlockAnimationManager() {
     addBezierWithName("linear", {0, 0}, {1, 1});
@@ -42,81 +43,158 @@ void updateColorVariable(CAnimatedVariable<CHyprColor>& av, const float POINTY,
     av.value() = {lerped, lerp(av.begun().a, av.goal().a, POINTY)};
 }
 
+// The blend of a gradient animation that got a new goal before it finished. Stops missing in the start gradient use its last one.
+static void bakeGradientLerp(const CGradientValueData& grad, std::vector<float>& okLabA, float& angle) {
+    const auto&  FROM      = grad.m_vLerpFromOkLabA;
+    const auto&  TO        = grad.m_vColorsOkLabA;
+    const size_t FROMSTOPS = FROM.size() / 4;
+
+    okLabA.resize(TO.size());
+    for (size_t i = 0; i < TO.size(); ++i) {
+        const float SOURCE = FROM[(std::min(i / 4, FROMSTOPS - 1) * 4) + (i % 4)];
+        okLabA[i]          = SOURCE + ((TO[i] - SOURCE) * grad.m_fLerp);
+    }
+
+    angle = grad.m_fLerpFromAngle + ((grad.m_fAngle - grad.m_fLerpFromAngle) * grad.m_fLerp);
+}
+
 void updateGradientVariable(CAnimatedVariable<CGradientValueData>& av, const float POINTY, bool warp = false) {
-    if (warp || av.value() == av.goal()) {
+    if (warp || (av.value() == av.goal() && !av.value().isLerping())) {
         av.warp(true, false);
         return;
     }
 
-    av.value().m_vColors.resize(av.goal().m_vColors.size(), av.goal().m_vColors.back());
+    // The stops are only touched on the first tick. After that, only the progress changes and renderBorder blends on the gpu.
+    auto& value = av.value();
+    if (!(value == av.goal())) {
+        std::vector<float> fromOkLabA = value.m_vColorsOkLabA;
+        float              fromAngle  = value.m_fAngle;
+        if (value.isLerping())
+            bakeGradientLerp(value, fromOkLabA, fromAngle);
+
+        value                   = av.goal();
+        value.m_vLerpFromOkLabA = std::move(fromOkLabA);
+        value.m_fLerpFromAngle  = fromAngle;
+    }
+
+    value.m_fLerp = POINTY;
+}
+
+// getPercent() is the progress right now. Move it ahead to when the frame will be on screen.
+static float percentAt(Hyprutils::Animation::CBaseAnimatedVariable& av, float aheadMs) {
+    const float PERCENT = av.getPercent();
+    const auto  PCONFIG = av.getConfig();
 
-    for (size_t i = 0; i < av.value().m_vColors.size(); ++i) {
-        const CHyprColor&          sourceCol = (i < av.begun().m_vColors.size()) ? av.begun().m_vColors[i] : av.begun().m_vColors.back();
-        const CHyprColor&          targetCol = (i < av.goal().m_vColors.size()) ? av.goal().m_vColors[i] : av.goal().m_vColors.back();
+    if (aheadMs <= 0.F || !PCONFIG || !PCONFIG->pValues || PCONFIG->pValues->internalSpeed <= 0.F)
+        return PERCENT;
 
-        const auto&                L1 = sourceCol.asOkLab();
-        const auto&                L2 = targetCol.asOkLab();
+    // internalSpeed is in ds
+    return std::clamp(PERCENT + (aheadMs / (PCONFIG->pValues->internalSpeed * 100.F)), 0.F, 1.F);
+}
 
-        static const auto          lerp = [](const float one, const float two, const float progress) -> float { return one + ((two - one) * progress); };
+float CHyprlockAnimationManager::SBezierLUT::at(float x) const {
+    const float  POS = std::clamp(x, 0.F, 1.F) * BEZIER_LUT_SIZE;
+    const size_t I   = std::min((size_t)POS, BEZIER_LUT_SIZE - 1);
+    return y[I] + ((y[I + 1] - y[I]) * (POS - I));
+}
 
-        const Hyprgraphics::CColor lerped = Hyprgraphics::CColor::SOkLab{
-            .l = lerp(L1.l, L2.l, POINTY),
-            .a = lerp(L1.a, L2.a, POINTY),
-            .b = lerp(L1.b, L2.b, POINTY),
-        };
+const CHyprlockAnimationManager::SBezierLUT* CHyprlockAnimationManager::lutFor(const std::string& bezierName) {
+    if (const auto IT = m_bezierLUTs.find(bezierName); IT != m_bezierLUTs.end())
+        return &IT->second;
 
-        av.value().m_vColors[i] = {lerped, lerp(sourceCol.a, targetCol.a, POINTY)};
+    auto&      lut     = m_bezierLUTs[bezierName];
+    const auto PBEZIER = getBezier(bezierName);
+    for (size_t i = 0; i <= BEZIER_LUT_SIZE; ++i) {
+        const float X = (float)i / BEZIER_LUT_SIZE;
+        lut.y[i]      = PBEZIER ? PBEZIER->getYForPoint(X) : X;
     }
 
-    if (av.begun().m_fAngle != av.goal().m_fAngle) {
-        const float DELTA   = av.goal().m_fAngle - av.begun().m_fAngle;
-        av.value().m_fAngle = av.begun().m_fAngle + DELTA * POINTY;
+    return &lut;
+}
+
+bool CHyprlockAnimationManager::activeChanged() const {
+    if (m_activeKeys.size() != m_vActiveAnimatedVariables.size())
+        return true;
+
+    for (size_t i = 0; i < m_activeKeys.size(); ++i) {
+        const auto& PAV = m_vActiveAnimatedVariables[i];
+        if (!PAV || PAV.get() != m_activeKeys[i].var || PAV->getConfig().get() != m_activeKeys[i].config)
+            return true;
     }
 
-    av.value().updateColorsOk();
+    return false;
 }
 
-void CHyprlockAnimationManager::tick() {
-    static const auto ANIMATIONSENABLED = g_pConfigManager->getValue<Hyprlang::INT>("animations:enabled");
+void CHyprlockAnimationManager::rebuildActive() {
+    m_activeFloats.clear();
+    m_activeVectors.clear();
+    m_activeColors.clear();
+    m_activeGradients.clear();
+    m_activeKeys.clear();
+
     for (const auto& PAV : m_vActiveAnimatedVariables) {
-        if (!PAV || !PAV->ok())
+        if (!PAV) {
+            m_activeKeys.push_back({});
             continue;
+        }
 
-        const auto SPENT   = PAV->getPercent();
-        const auto PBEZIER = getBezier(PAV->getBezierName());
-        const auto POINTY  = PBEZIER->getYForPoint(SPENT);
-        const bool WARP    = !*ANIMATIONSENABLED || SPENT >= 1.f;
+        m_activeKeys.push_back({PAV.get(), PAV->getConfig().get()});
 
+        if (!PAV->ok())
+            continue;
+
+        // m_Type is set by createAnimation, so the static_casts are safe.
+        const auto PLUT = lutFor(PAV->getBezierName());
         switch (PAV->m_Type) {
-            case AVARTYPE_FLOAT: {
-                auto pTypedAV = dynamic_cast<CAnimatedVariable<float>*>(PAV.get());
-                RASSERT(pTypedAV, "Failed to upcast animated float");
-                updateVariable(*pTypedAV, POINTY, WARP);
-            } break;
-            case AVARTYPE_VECTOR: {
-                auto pTypedAV = dynamic_cast<CAnimatedVariable<Vector2D>*>(PAV.get());
-                RASSERT(pTypedAV, "Failed to upcast animated Vector2D");
-                updateVariable(*pTypedAV, POINTY, WARP);
-            } break;
-            case AVARTYPE_COLOR: {
-                auto pTypedAV = dynamic_cast<CAnimatedVariable<CHyprColor>*>(PAV.get());
-                RASSERT(pTypedAV, "Failed to upcast animated CHyprColor");
-                updateColorVariable(*pTypedAV, POINTY, WARP);
-            } break;
-            case AVARTYPE_GRADIENT: {
-                auto pTypedAV = dynamic_cast<CAnimatedVariable<CGradientValueData>*>(PAV.get());
-                RASSERT(pTypedAV, "Failed to upcast animated CGradientValueData");
-                updateGradientVariable(*pTypedAV, POINTY, WARP);
-            } break;
-            default: continue;
+            case AVARTYPE_FLOAT: m_activeFloats.push_back({PAV, static_cast<CAnimatedVariable<float>*>(PAV.get()), PLUT}); break;
+            case AVARTYPE_VECTOR: m_activeVectors.push_back({PAV, static_cast<CAnimatedVariable<Vector2D>*>(PAV.get()), PLUT}); break;
+            case AVARTYPE_COLOR: m_activeColors.push_back({PAV, static_cast<CAnimatedVariable<CHyprColor>*>(PAV.get()), PLUT}); break;
+            case AVARTYPE_GRADIENT: m_activeGradients.push_back({PAV, static_cast<CAnimatedVariable<CGradientValueData>*>(PAV.get()), PLUT}); break;
+            default: break;
         }
+    }
+}
+
+template <Animable VarType, typename Update>
+void CHyprlockAnimationManager::tickVariables(const std::vector<SActiveVariable<VarType>>& variables, float aheadMs, bool forceWarp, Update&& update) {
+    for (const auto& [ref, var, bezier] : variables) {
+        if (!ref || !var->ok())
+            continue;
 
-        PAV->onUpdate();
+        const auto SPENT = percentAt(*var, aheadMs);
+        update(*var, bezier->at(SPENT), forceWarp || SPENT >= 1.f);
+
+        var->onUpdate();
     }
+}
+
+void CHyprlockAnimationManager::tick(std::chrono::steady_clock::time_point presentAt) {
+    if (m_ticked)
+        return;
+
+    m_ticked = true;
+
+    static const auto ANIMATIONSENABLED = g_pConfigManager->getValue<Hyprlang::INT>("animations:enabled");
+
+    m_lastPresentAt     = std::max(m_lastPresentAt, presentAt);
+    const float AHEADMS = std::chrono::duration<float, std::milli>(m_lastPresentAt - std::chrono::steady_clock::now()).count();
+    const bool  WARP    = !*ANIMATIONSENABLED;
+
+    if (activeChanged())
+        rebuildActive();
+
+    tickVariables(m_activeFloats, AHEADMS, WARP, updateVariable<float>);
+    tickVariables(m_activeVectors, AHEADMS, WARP, updateVariable<Vector2D>);
+    tickVariables(m_activeColors, AHEADMS, WARP, updateColorVariable);
+    tickVariables(m_activeGradients, AHEADMS, WARP, updateGradientVariable);
 
     tickDone();
 }
 
+void CHyprlockAnimationManager::beginFrame() {
+    m_ticked = false;
+}
+
 void CHyprlockAnimationManager::scheduleTick() {
     m_bTickScheduled = true;
 }
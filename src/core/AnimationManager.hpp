@@ -5,12 +5,21 @@
 
 #include "../helpers/AnimatedVariable.hpp"
 #include "../defines.hpp"
+#include <array>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 class CHyprlockAnimationManager : public Hyprutils::Animation::CAnimationManager {
   public:
     CHyprlockAnimationManager();
 
-    void         tick();
+    // Advances all animations to where they should be at presentAt.
+    // Only the first call after beginFrame() does anything, so outputs rendering in the same loop iteration share one tick.
+    void         tick(std::chrono::steady_clock::time_point presentAt = std::chrono::steady_clock::now());
+    // Called once per event loop iteration.
+    void         beginFrame();
     virtual void scheduleTick();
     virtual void onTicked();
 
@@ -26,6 +35,52 @@ class CHyprlockAnimationManager : public Hyprutils::Animation::CAnimationManager
     }
 
     bool m_bTickScheduled = false;
+
+  private:
+    static constexpr size_t BEZIER_LUT_SIZE = 256;
+
+    // A bezier curve sampled at evenly spaced x values. Lerping between them is way cheaper than solving the curve for every variable.
+    struct SBezierLUT {
+        std::array<float, BEZIER_LUT_SIZE + 1> y = {};
+
+        float                                  at(float x) const;
+    };
+
+    using CActiveRef = decltype(m_vActiveAnimatedVariables)::value_type;
+
+    // Callbacks of one variable can destroy another one, ref tells us if var is still alive.
+    template <Animable VarType>
+    struct SActiveVariable {
+        CActiveRef                  ref;
+        CAnimatedVariable<VarType>* var    = nullptr;
+        const SBezierLUT*           bezier = nullptr;
+    };
+
+    // What the per type arrays were built from.
+    struct SActiveKey {
+        const Hyprutils::Animation::CBaseAnimatedVariable* var    = nullptr;
+        const SAnimationPropertyConfig*                    config = nullptr;
+    };
+
+    // Active variables by type. Only rebuilt when an animation starts, ends or gets a new config.
+    std::vector<SActiveVariable<float>>              m_activeFloats;
+    std::vector<SActiveVariable<Vector2D>>           m_activeVectors;
+    std::vector<SActiveVariable<CHyprColor>>         m_activeColors;
+    std::vector<SActiveVariable<CGradientValueData>> m_activeGradients;
+    std::vector<SActiveKey>                          m_activeKeys;
+
+    std::unordered_map<std::string, SBezierLUT>      m_bezierLUTs;
+
+    bool                                             m_ticked = false;
+    // Outputs present at different times. Ticking for an earlier one must not move animations back.
+    std::chrono::steady_clock::time_point m_lastPresentAt;
+
+    bool                                  activeChanged() const;
+    void                                  rebuildActive();
+    const SBezierLUT*                     lutFor(const std::string& bezierName);
+
+    template <Animable VarType, typename Update>
+    void tickVariables(const std::vector<SActiveVariable<VarType>>& variables, float aheadMs, bool forceWarp, Update&& update);
 };
 
 inline UP<CHyprlockAnimationManager> g_pAnimationManager;
@@ -88,3 +88,11 @@ CEGL::~CEGL() {
 void CEGL::makeCurrent(EGLSurface surf) {
     eglMakeCurrent(eglDisplay, surf, surf, eglContext);
 }
+
+EGLContext CEGL::createSharedContext() {
+    const auto CONTEXT = eglCreateContext(eglDisplay, eglConfig, eglContext, context_attribs);
+    if (CONTEXT == EGL_NO_CONTEXT)
+        Debug::log(ERR, "Failed to create a shared EGL context (egl error {:x})", eglGetError());
+
+    return CONTEXT;
+}
@@ -17,6 +17,8 @@ class CEGL {
     PFNEGLCREATEPLATFORMWINDOWSURFACEEXTPROC eglCreatePlatformWindowSurfaceEXT;
 
     void                                     makeCurrent(EGLSurface surf);
+    // Creates a context that shares objects with eglContext. Returns EGL_NO_CONTEXT on failure.
+    EGLContext                               createSharedContext();
 
     bool                                     m_isNvidia = false;
 };
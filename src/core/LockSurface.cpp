@@ -6,6 +6,9 @@
 #include "../helpers/Log.hpp"
 #include "../renderer/Renderer.hpp"
 
+// How long a frame callback may take before we assume the output is off, unless the compositor tells us the power state.
+constexpr auto FRAME_CALLBACK_TIMEOUT = std::chrono::seconds(2);
+
 CSessionLockSurface::~CSessionLockSurface() {
     if (frameCallback)
         frameCallback.reset();
@@ -108,14 +111,33 @@ void CSessionLockSurface::onScaleUpdate() {
 }
 
 void CSessionLockSurface::render() {
-    if (frameCallback || !readyForFrame) {
+    const auto POUTPUT = m_outputRef.lock();
+
+    if (frameCallback && POUTPUT && !POUTPUT->knowsPowerState() && std::chrono::steady_clock::now() - m_frameRequested > FRAME_CALLBACK_TIMEOUT)
+        POUTPUT->setFramesStalled(true);
+
+    if (frameCallback || !readyForFrame || (POUTPUT && POUTPUT->suspended())) {
         needsFrame = true;
         return;
     }
 
-    g_pAnimationManager->tick();
+    g_pAnimationManager->tick(predictPresentation());
     const auto FEEDBACK = g_pRenderer->renderLock(*this);
     frameCallback       = makeShared<CCWlCallback>(surface->sendFrame());
+    m_frameRequested    = std::chrono::steady_clock::now();
+
+    if (const auto PPRESENTATION = g_pHyprlock->getPresentation(); PPRESENTATION) {
+        // Feedback for a frame only arrives once it got presented or discarded, which can be after the next render.
+        const auto PFEEDBACK = m_presentationFeedbacks.emplace_back(makeShared<CCWpPresentationFeedback>(PPRESENTATION->sendFeedback(surface->resource())));
+        PFEEDBACK->setPresented(
+            [this](CCWpPresentationFeedback* r, uint32_t tvSecHi, uint32_t tvSecLo, uint32_t tvNsec, uint32_t refresh, uint32_t seqHi, uint32_t seqLo, uint32_t flags) {
+                const auto SEC     = ((uint64_t)tvSecHi << 32) | tvSecLo;
+                m_lastPresentation = std::chrono::steady_clock::time_point{std::chrono::seconds(SEC) + std::chrono::nanoseconds(tvNsec)};
+                m_refreshInterval  = std::chrono::nanoseconds(refresh);
+                removePresentationFeedback(r);
+            });
+        PFEEDBACK->setDiscarded([this](CCWpPresentationFeedback* r) { removePresentationFeedback(r); });
+    }
     frameCallback->setDone([this](CCWlCallback* r, uint32_t frameTime) {
         if (g_pHyprlock->m_bTerminate)
             return;
@@ -140,12 +162,47 @@ void CSessionLockSurface::render() {
 void CSessionLockSurface::onCallback() {
     frameCallback.reset();
 
+    if (const auto POUTPUT = m_outputRef.lock(); POUTPUT)
+        POUTPUT->setFramesStalled(false);
+
     if (needsFrame && !g_pHyprlock->m_bTerminate && g_pEGL) {
         needsFrame = false;
         render();
     }
 }
 
+void CSessionLockSurface::removePresentationFeedback(CCWpPresentationFeedback* feedback) {
+    std::erase_if(m_presentationFeedbacks, [feedback](const auto& f) { return f.get() == feedback; });
+}
+
+std::chrono::steady_clock::time_point CSessionLockSurface::predictPresentation() const {
+    const auto NOW = std::chrono::steady_clock::now();
+
+    auto       interval = m_refreshInterval;
+    if (interval.count() == 0) {
+        // No feedback yet or the output has no fixed refresh rate. Fall back to the mode.
+        if (const auto POUTPUT = m_outputRef.lock(); POUTPUT && POUTPUT->refresh > 0)
+            interval = std::chrono::nanoseconds(1000000000000LL / POUTPUT->refresh);
+        else
+            return NOW;
+    }
+
+    if (m_lastPresentation.time_since_epoch().count() == 0 || m_lastPresentation > NOW)
+        return NOW + interval;
+
+    // The first vblank after now. If we are running late, that skips the ones we missed instead of rendering stale frames.
+    const auto VBLANKS = ((NOW - m_lastPresentation) / interval) + 1;
+    return m_lastPresentation + (VBLANKS * interval);
+}
+
+void CSessionLockSurface::onResume() {
+    // The frame callback requested before the output went off might never arrive.
+    if (frameCallback && std::chrono::steady_clock::now() - m_frameRequested > FRAME_CALLBACK_TIMEOUT)
+        frameCallback.reset();
+
+    render();
+}
+
 SP<CCWlSurface> CSessionLockSurface::getWlSurface() {
     return surface;
 }
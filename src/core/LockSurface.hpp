@@ -5,9 +5,11 @@
 #include "ext-session-lock-v1.hpp"
 #include "viewporter.hpp"
 #include "fractional-scale-v1.hpp"
+#include "presentation-time.hpp"
 #include "../helpers/Math.hpp"
 #include <wayland-egl.h>
 #include <EGL/egl.h>
+#include <chrono>
 
 class COutput;
 class CRenderer;
@@ -26,6 +28,8 @@ class CSessionLockSurface {
     void            render();
     void            onCallback();
     void            onScaleUpdate();
+    // Renders once after the output got powered on again.
+    void            onResume();
     SP<CCWlSurface> getWlSurface();
 
   private:
@@ -48,6 +52,20 @@ class CSessionLockSurface {
     uint32_t                      m_lastFrameTime = 0;
     uint32_t                      m_frames        = 0;
 
+    // When frameCallback was requested. Compositors don't send frame callbacks for outputs that are off.
+    std::chrono::steady_clock::time_point m_frameRequested;
+
+    // Last vblank and refresh interval reported by wp_presentation.
+    std::chrono::steady_clock::time_point m_lastPresentation;
+    std::chrono::nanoseconds              m_refreshInterval{0};
+
+    // One per rendered frame that is neither presented nor discarded yet.
+    std::vector<SP<CCWpPresentationFeedback>> m_presentationFeedbacks;
+
+    // When the frame rendered now will most likely be shown. Animations are ticked to that point.
+    std::chrono::steady_clock::time_point predictPresentation() const;
+    void                                  removePresentationFeedback(CCWpPresentationFeedback* feedback);
+
     // wayland callbacks
     SP<CCWlCallback> frameCallback = nullptr;
 
@@ -1,5 +1,6 @@
 #include "Output.hpp"
 #include "../helpers/Log.hpp"
+#include "../renderer/Renderer.hpp"
 #include "hyprlock.hpp"
 
 void COutput::create(WP<COutput> pSelf, SP<CCWlOutput> pWlOutput, uint32_t _name) {
@@ -29,12 +30,15 @@ void COutput::create(WP<COutput> pSelf, SP<CCWlOutput> pWlOutput, uint32_t _name
         }
     });
 
-    m_wlOutput->setMode([this](CCWlOutput* r, uint32_t flags, int32_t width, int32_t height, int32_t refresh) {
+    m_wlOutput->setMode([this](CCWlOutput* r, uint32_t flags, int32_t width, int32_t height, int32_t refresh_) {
         // handle portrait mode and flipped cases
         if (transform % 2 == 1)
             size = {height, width};
         else
             size = {width, height};
+
+        if (flags & WL_OUTPUT_MODE_CURRENT)
+            refresh = refresh_;
     });
 
     m_wlOutput->setGeometry(
@@ -61,9 +65,63 @@ void COutput::createSessionLockSurface() {
         return;
     }
 
+    if (const auto PPOWERMGR = g_pHyprlock->getOutputPowerMgr(); PPOWERMGR && !m_outputPower) {
+        m_outputPower = makeShared<CCZwlrOutputPowerV1>(PPOWERMGR->sendGetOutputPower(m_wlOutput->resource()));
+
+        m_outputPower->setMode([this](CCZwlrOutputPowerV1* r, uint32_t mode) {
+            m_powerStateKnown = true;
+            setPoweredOff(mode == ZWLR_OUTPUT_POWER_V1_MODE_OFF);
+        });
+
+        m_outputPower->setFailed([this](CCZwlrOutputPowerV1* r) {
+            Debug::log(LOG, "output {} has no power management, falling back to frame callbacks", m_ID);
+            m_powerStateKnown = false;
+            setPoweredOff(false);
+        });
+    }
+
     m_sessionLockSurface = makeUnique<CSessionLockSurface>(m_self.lock());
 }
 
 Vector2D COutput::getViewport() const {
     return (m_sessionLockSurface) ? m_sessionLockSurface->size : size;
 }
+
+bool COutput::matchesMonitor(const std::string& monitor) const {
+    return monitor.empty() || monitor == stringPort || stringDesc.starts_with(monitor) || ("desc:" + stringDesc).starts_with(monitor);
+}
+
+bool COutput::suspended() const {
+    return m_poweredOff || m_framesStalled;
+}
+
+bool COutput::knowsPowerState() const {
+    return m_powerStateKnown;
+}
+
+void COutput::setFramesStalled(bool stalled) {
+    const bool WASSUSPENDED = suspended();
+    m_framesStalled         = stalled;
+    onSuspendedChanged(WASSUSPENDED);
+}
+
+void COutput::setPoweredOff(bool off) {
+    const bool WASSUSPENDED = suspended();
+    m_poweredOff            = off;
+    onSuspendedChanged(WASSUSPENDED);
+}
+
+void COutput::onSuspendedChanged(bool wasSuspended) {
+    const bool SUSPENDED = suspended();
+    if (SUSPENDED == wasSuspended)
+        return;
+
+    Debug::log(LOG, "output {} {}", stringPort, SUSPENDED ? "is off, suspending its widgets" : "is back on, resuming its widgets");
+
+    if (g_pRenderer)
+        g_pRenderer->setWidgetsSuspended(m_ID, SUSPENDED);
+
+    // Catch up on whatever changed while the output was off.
+    if (!SUSPENDED && m_sessionLockSurface)
+        m_sessionLockSurface->onResume();
+}
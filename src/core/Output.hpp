@@ -2,6 +2,7 @@
 
 #include "../defines.hpp"
 #include "wayland.hpp"
+#include "wlr-output-power-management-unstable-v1.hpp"
 #include "LockSurface.hpp"
 
 class COutput {
@@ -17,17 +18,35 @@ class COutput {
     wl_output_transform     transform = WL_OUTPUT_TRANSFORM_NORMAL;
     Vector2D                size;
     int                     scale      = 1;
+    int32_t                 refresh    = 0; // mHz of the current mode, 0 if unknown
     std::string             stringName = "";
     std::string             stringPort = "";
     std::string             stringDesc = "";
 
     UP<CSessionLockSurface> m_sessionLockSurface;
 
-    SP<CCWlOutput>          m_wlOutput = nullptr;
+    SP<CCWlOutput>          m_wlOutput    = nullptr;
+    SP<CCZwlrOutputPowerV1> m_outputPower = nullptr;
 
     WP<COutput>             m_self;
 
     void                    createSessionLockSurface();
 
     Vector2D                getViewport() const;
+    // Whether a widget with the `monitor` config value applies to this output.
+    bool                    matchesMonitor(const std::string& monitor) const;
+
+    // Outputs are suspended while they are powered off. Their widgets pause timers and free framebuffers they can regenerate.
+    // Without wlr-output-power-management, overdue frame callbacks are taken as the output being off.
+    bool suspended() const;
+    bool knowsPowerState() const;
+    void setFramesStalled(bool stalled);
+
+  private:
+    bool m_poweredOff      = false;
+    bool m_powerStateKnown = false;
+    bool m_framesStalled   = false;
+
+    void setPoweredOff(bool off);
+    void onSuspendedChanged(bool wasSuspended);
 };
@@ -1,16 +1,24 @@
 #include "Timer.hpp"
+#include "hyprlock.hpp"
+#include <utility>
 
-CTimer::CTimer(std::chrono::system_clock::duration timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data_, bool force) :
+CTimer::CTimer(std::chrono::steady_clock::duration timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data_, bool force) :
     cb(cb_), data(data_), allowForceUpdate(force) {
-    expires = std::chrono::system_clock::now() + timeout;
+    if (timeout == TIMER_NO_DEADLINE)
+        expires = std::chrono::steady_clock::time_point::max();
+    else
+        expires = std::chrono::steady_clock::now() + timeout;
 }
 
 bool CTimer::passed() {
-    return std::chrono::system_clock::now() > expires;
+    return std::chrono::steady_clock::now() > expires;
 }
 
 void CTimer::cancel() {
     wasCancelled = true;
+
+    if (g_pHyprlock)
+        g_pHyprlock->removeTimer(this);
 }
 
 bool CTimer::cancelled() {
@@ -22,9 +30,107 @@ void CTimer::call(ASP<CTimer> self) {
 }
 
 float CTimer::leftMs() {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(expires - std::chrono::system_clock::now()).count();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(expires - std::chrono::steady_clock::now()).count();
+}
+
+std::chrono::steady_clock::time_point CTimer::expiry() const {
+    return expires;
 }
 
 bool CTimer::canForceUpdate() {
     return allowForceUpdate;
 }
+
+bool CTimer::hasDeadline() const {
+    return expires != std::chrono::steady_clock::time_point::max();
+}
+
+void CTimerQueue::push(const ASP<CTimer>& timer) {
+    if (timer->heapIndex != CTimer::NOT_QUEUED)
+        return;
+
+    timer->heapIndex = m_heap.size();
+    m_heap.emplace_back(timer);
+    siftUp(m_heap.size() - 1);
+}
+
+bool CTimerQueue::remove(CTimer* timer) {
+    const size_t I = timer->heapIndex;
+    if (I >= m_heap.size() || m_heap[I].get() != timer)
+        return false;
+
+    const size_t LAST = m_heap.size() - 1;
+    if (I != LAST)
+        swapNodes(I, LAST);
+
+    m_heap.back()->heapIndex = CTimer::NOT_QUEUED;
+    m_heap.pop_back();
+
+    if (I < m_heap.size()) {
+        siftUp(I);
+        siftDown(I);
+    }
+
+    return true;
+}
+
+ASP<CTimer> CTimerQueue::top() const {
+    return m_heap.empty() ? nullptr : m_heap.front();
+}
+
+ASP<CTimer> CTimerQueue::pop() {
+    if (m_heap.empty())
+        return nullptr;
+
+    auto timer = m_heap.front();
+    remove(timer.get());
+    return timer;
+}
+
+bool CTimerQueue::empty() const {
+    return m_heap.empty();
+}
+
+const std::vector<ASP<CTimer>>& CTimerQueue::timers() const {
+    return m_heap;
+}
+
+bool CTimerQueue::before(size_t a, size_t b) const {
+    return m_heap[a]->expires < m_heap[b]->expires;
+}
+
+void CTimerQueue::swapNodes(size_t a, size_t b) {
+    std::swap(m_heap[a], m_heap[b]);
+    m_heap[a]->heapIndex = a;
+    m_heap[b]->heapIndex = b;
+}
+
+void CTimerQueue::siftUp(size_t i) {
+    while (i > 0) {
+        const size_t PARENT = (i - 1) / 2;
+        if (!before(i, PARENT))
+            break;
+
+        swapNodes(i, PARENT);
+        i = PARENT;
+    }
+}
+
+void CTimerQueue::siftDown(size_t i) {
+    while (true) {
+        const size_t LEFT     = (2 * i) + 1;
+        const size_t RIGHT    = LEFT + 1;
+        size_t       smallest = i;
+
+        if (LEFT < m_heap.size() && before(LEFT, smallest))
+            smallest = LEFT;
+        if (RIGHT < m_heap.size() && before(RIGHT, smallest))
+            smallest = RIGHT;
+
+        if (smallest == i)
+            break;
+
+        swapNodes(i, smallest);
+        i = smallest;
+    }
+}
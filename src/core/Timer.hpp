@@ -1,26 +1,63 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <functional>
+#include <vector>
 #include "../defines.hpp"
 
+// Timers with this timeout never expire on their own, they only run when they get force updated.
+// They stay out of the loops deadline, so an idle lock screen doesn't wake up for them.
+inline constexpr auto TIMER_NO_DEADLINE = std::chrono::steady_clock::duration::max();
+
 class CTimer {
   public:
-    CTimer(std::chrono::system_clock::duration timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data_, bool force);
+    CTimer(std::chrono::steady_clock::duration timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data_, bool force);
 
-    void  cancel();
-    bool  passed();
-    bool  canForceUpdate();
+    // Also takes the timer out of the queue.
+    void                                  cancel();
+    bool                                  passed();
+    bool                                  canForceUpdate();
+    bool                                  hasDeadline() const;
 
-    float leftMs();
+    float                                 leftMs();
+    std::chrono::steady_clock::time_point expiry() const;
 
-    bool  cancelled();
-    void  call(ASP<CTimer> self);
+    bool                                  cancelled();
+    void                                  call(ASP<CTimer> self);
 
   private:
+    static constexpr size_t                           NOT_QUEUED = SIZE_MAX;
+
     std::function<void(ASP<CTimer> self, void* data)> cb;
     void*                                             data = nullptr;
-    std::chrono::system_clock::time_point             expires;
+    std::chrono::steady_clock::time_point             expires;
     bool                                              wasCancelled     = false;
     bool                                              allowForceUpdate = false;
+    // Position in the CTimerQueue heap.
+    size_t heapIndex = NOT_QUEUED;
+
+    friend class CTimerQueue;
+};
+
+// Binary min-heap on the expiry time. Timers know their position, so removing one doesn't need a search.
+// Not thread safe, the owner has to lock.
+class CTimerQueue {
+  public:
+    // push, remove and pop are O(log n), top is O(1).
+    // remove returns false if the timer wasn't queued, top and pop return nullptr if the queue is empty.
+    void                            push(const ASP<CTimer>& timer);
+    bool                            remove(CTimer* timer);
+    ASP<CTimer>                     top() const;
+    ASP<CTimer>                     pop();
+    bool                            empty() const;
+    const std::vector<ASP<CTimer>>& timers() const; // in heap order
+
+  private:
+    void                     siftUp(size_t i);
+    void                     siftDown(size_t i);
+    void                     swapNodes(size_t a, size_t b);
+    bool                     before(size_t a, size_t b) const;
+
+    std::vector<ASP<CTimer>> m_heap;
 };
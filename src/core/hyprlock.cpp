@@ -3,22 +3,29 @@
 #include "../config/ConfigManager.hpp"
 #include "../renderer/Renderer.hpp"
 #include "../renderer/AsyncResourceManager.hpp"
+#include "../renderer/GPUWorker.hpp"
 #include "../auth/Auth.hpp"
 #include "../auth/Fingerprint.hpp"
 #include "./Egl.hpp"
 #include "./Seat.hpp"
+#include "./AnimationManager.hpp"
 #include <chrono>
 #include <hyprutils/memory/UniquePtr.hpp>
 #include <sys/wait.h>
-#include <sys/poll.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <csignal>
 #include <unistd.h>
 #include <cassert>
 #include <cstring>
+#include <cmath>
 #include <xf86drm.h>
 #include <algorithm>
+#include <array>
 #include <sdbus-c++/sdbus-c++.h>
 #include <hyprutils/os/Process.hpp>
 #include <malloc.h>
@@ -35,6 +42,19 @@ static void setMallocThreshold() {
 #endif
 }
 
+static sigset_t loopSignals() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1); // unlock
+    sigaddset(&signals, SIGUSR2); // force update
+    return signals;
+}
+
+void CHyprlock::blockLoopSignals() {
+    const auto SIGNALS = loopSignals();
+    pthread_sigmask(SIG_BLOCK, &SIGNALS, nullptr);
+}
+
 CHyprlock::CHyprlock(const std::string& wlDisplay, const bool immediateRender, const int graceSeconds) {
     setMallocThreshold();
 
@@ -51,6 +71,9 @@ CHyprlock::CHyprlock(const std::string& wlDisplay, const bool immediateRender, c
     static const auto IMMEDIATERENDER = g_pConfigManager->getValue<Hyprlang::INT>("general:immediate_render");
     m_bImmediateRender                = immediateRender || *IMMEDIATERENDER;
 
+    m_sLoopState.timerWakeupFd = Hyprutils::OS::CFileDescriptor{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+    m_sLoopState.loopThread    = std::this_thread::get_id();
+
     const auto CURRENTDESKTOP = getenv("XDG_CURRENT_DESKTOP");
     const auto SZCURRENTD     = std::string{CURRENTDESKTOP ? CURRENTDESKTOP : ""};
     m_sCurrentDesktop         = SZCURRENTD;
@@ -61,36 +84,6 @@ CHyprlock::~CHyprlock() {
         gbm_device_destroy(dma.gbmDevice);
 }
 
-static void registerSignalAction(int sig, void (*handler)(int), int sa_flags = 0) {
-    struct sigaction sa;
-    sa.sa_handler = handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = sa_flags;
-    sigaction(sig, &sa, nullptr);
-}
-
-static void handleUnlockSignal(int sig) {
-    if (sig == SIGUSR1) {
-        Debug::log(LOG, "Unlocking with a SIGUSR1");
-        g_pAuth->enqueueUnlock();
-    }
-}
-
-static void handleForceUpdateSignal(int sig) {
-    if (sig == SIGUSR2) {
-        for (auto& t : g_pHyprlock->getTimers()) {
-            if (t->canForceUpdate()) {
-                t->call(t);
-                t->cancel();
-            }
-        }
-    }
-}
-
-static void handlePollTerminate(int sig) {
-    ;
-}
-
 static char* gbm_find_render_node(drmDevice* device) {
     drmDevice* devices[64];
     char*      render_node = nullptr;
@@ -133,6 +126,26 @@ gbm_device* CHyprlock::createGBMDevice(drmDevice* dev) {
     return gbm_create_device(fd);
 }
 
+bool CHyprlock::isGBMDevice(dev_t device) {
+    if (!dma.gbmDevice)
+        return false;
+
+    drmDevice* drmDev = nullptr;
+    if (drmGetDeviceFromDevId(device, /* flags */ 0, &drmDev) != 0)
+        return false;
+
+    drmDevice* drmDevRenderer = nullptr;
+    if (drmGetDevice2(gbm_device_get_fd(dma.gbmDevice), /* flags */ 0, &drmDevRenderer) != 0) {
+        drmFreeDevice(&drmDev);
+        return false;
+    }
+
+    const bool EQUAL = drmDevicesEqual(drmDevRenderer, drmDev);
+    drmFreeDevice(&drmDev);
+    drmFreeDevice(&drmDevRenderer);
+    return EQUAL;
+}
+
 void CHyprlock::addDmabufListener() {
     dma.linuxDmabufFeedback->setTrancheDone([this](CCZwpLinuxDmabufFeedbackV1* r) {
         Debug::log(TRACE, "[core] dmabufFeedbackTrancheDone");
@@ -289,9 +302,26 @@ void CHyprlock::run() {
                 makeShared<CCWpFractionalScaleManagerV1>((wl_proxy*)wl_registry_bind((wl_registry*)r->resource(), name, &wp_fractional_scale_manager_v1_interface, 1));
         else if (IFACE == wp_viewporter_interface.name)
             m_sWaylandState.viewporter = makeShared<CCWpViewporter>((wl_proxy*)wl_registry_bind((wl_registry*)r->resource(), name, &wp_viewporter_interface, 1));
+        else if (IFACE == wp_presentation_interface.name) {
+            m_sWaylandState.presentation = makeShared<CCWpPresentation>((wl_proxy*)wl_registry_bind((wl_registry*)r->resource(), name, &wp_presentation_interface, 1));
+            m_sWaylandState.presentation->setClockId([this](CCWpPresentation* r, uint32_t clockID) {
+                m_sWaylandState.presentationClock = clockID;
+                if (clockID != CLOCK_MONOTONIC)
+                    Debug::log(LOG, "Presentation clock {} is not CLOCK_MONOTONIC, animations won't follow vblanks", clockID);
+            });
+        }
         else if (IFACE == zwlr_screencopy_manager_v1_interface.name)
             m_sWaylandState.screencopy =
                 makeShared<CCZwlrScreencopyManagerV1>((wl_proxy*)wl_registry_bind((wl_registry*)r->resource(), name, &zwlr_screencopy_manager_v1_interface, 3));
+        else if (IFACE == ext_image_copy_capture_manager_v1_interface.name)
+            m_sWaylandState.imageCopyCapture = makeShared<CCExtImageCopyCaptureManagerV1>(
+                (wl_proxy*)wl_registry_bind((wl_registry*)r->resource(), name, &ext_image_copy_capture_manager_v1_interface, 1));
+        else if (IFACE == ext_output_image_capture_source_manager_v1_interface.name)
+            m_sWaylandState.outputCaptureSource = makeShared<CCExtOutputImageCaptureSourceManagerV1>(
+                (wl_proxy*)wl_registry_bind((wl_registry*)r->resource(), name, &ext_output_image_capture_source_manager_v1_interface, 1));
+        else if (IFACE == zwlr_output_power_manager_v1_interface.name)
+            m_sWaylandState.outputPower =
+                makeShared<CCZwlrOutputPowerManagerV1>((wl_proxy*)wl_registry_bind((wl_registry*)r->resource(), name, &zwlr_output_power_manager_v1_interface, 1));
         else if (IFACE == wl_shm_interface.name)
             m_sWaylandState.shm = makeShared<CCWlShm>((wl_proxy*)wl_registry_bind((wl_registry*)r->resource(), name, &wl_shm_interface, 1));
         else
@@ -319,6 +349,7 @@ void CHyprlock::run() {
     wl_display_roundtrip(m_sWaylandState.display);
 
     g_pRenderer            = makeUnique<CRenderer>();
+    g_pGPUWorker           = makeUnique<CGPUWorker>();
     g_asyncResourceManager = makeUnique<CAsyncResourceManager>();
     g_pAuth                = makeUnique<CAuth>();
     g_pAuth->start();
@@ -336,8 +367,6 @@ void CHyprlock::run() {
 
     // Failed to lock the session
     if (!acquireSessionLock()) {
-        m_sLoopState.timerEvent = true;
-        m_sLoopState.timerCV.notify_all();
         g_pAuth->terminate();
         exit(1);
     }
@@ -345,134 +374,145 @@ void CHyprlock::run() {
     const auto fingerprintAuth = g_pAuth->getImpl(AUTH_IMPL_FINGERPRINT);
     const auto dbusConn        = (fingerprintAuth) ? ((CFingerprint*)fingerprintAuth.get())->getConnection() : nullptr;
 
-    registerSignalAction(SIGUSR1, handleUnlockSignal, SA_RESTART);
-    registerSignalAction(SIGUSR2, handleForceUpdateSignal);
-    registerSignalAction(SIGRTMIN, handlePollTerminate);
-
-    pollfd pollfds[2];
-    pollfds[0] = {
-        .fd     = wl_display_get_fd(m_sWaylandState.display),
-        .events = POLLIN,
-    };
-    if (dbusConn) {
-        pollfds[1] = {
-            .fd     = dbusConn->getEventLoopPollData().fd,
-            .events = POLLIN,
-        };
-    }
-    size_t      fdcount = dbusConn ? 2 : 1;
+    const auto SIGNALS      = loopSignals();
+    const auto WLFD         = wl_display_get_fd(m_sWaylandState.display);
+    const auto DBUSFD       = dbusConn ? dbusConn->getEventLoopPollData().fd : -1;
+    const auto COMPLETIONFD = g_asyncResourceManager->completionFd();
 
-    std::thread pollThr([this, &pollfds, fdcount]() {
-        while (!m_bTerminate) {
-            bool preparedToRead = wl_display_prepare_read(m_sWaylandState.display) == 0;
+    CFileDescriptor epollFd{epoll_create1(EPOLL_CLOEXEC)};
+    CFileDescriptor timerFd{timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)};
+    CFileDescriptor signalFd{signalfd(-1, &SIGNALS, SFD_CLOEXEC | SFD_NONBLOCK)};
+    RASSERT(epollFd.isValid() && timerFd.isValid() && signalFd.isValid() && m_sLoopState.timerWakeupFd.isValid(), "[core] Failed to create the event loop fds");
 
-            int  events = 0;
-            if (preparedToRead) {
-                events = poll(pollfds, fdcount, 5000);
+    for (const int FD : {WLFD, DBUSFD, COMPLETIONFD, timerFd.get(), m_sLoopState.timerWakeupFd.get(), signalFd.get()}) {
+        if (FD < 0)
+            continue;
 
-                if (events < 0) {
-                    RASSERT(errno == EINTR, "[core] Polling fds failed with {}", errno);
-                    wl_display_cancel_read(m_sWaylandState.display);
-                    continue;
-                }
+        epoll_event ev = {.events = EPOLLIN, .data = {.fd = FD}};
+        RASSERT(epoll_ctl(epollFd.get(), EPOLL_CTL_ADD, FD, &ev) == 0, "[core] epoll_ctl failed with {}", errno);
+    }
 
-                for (size_t i = 0; i < fdcount; ++i) {
-                    RASSERT(!(pollfds[i].revents & POLLHUP), "[core] Disconnected from pollfd id {}", i);
-                }
+    g_pRenderer->startFadeIn();
 
-                wl_display_read_events(m_sWaylandState.display);
-                m_sLoopState.wlDispatched = false;
-            }
+    processTimers();
+    armTimerFd(timerFd.get());
 
-            if (events > 0 || !preparedToRead) {
-                Debug::log(TRACE, "[core] got poll event");
-                std::unique_lock lk(m_sLoopState.eventLoopMutex);
-                m_sLoopState.event = true;
-                m_sLoopState.loopCV.notify_all();
+    // Why the loop woke up. Without animations or timers with a deadline this should stay at zero.
+    struct {
+        size_t total     = 0;
+        size_t wayland   = 0;
+        size_t timer     = 0;
+        size_t dbus      = 0;
+        size_t resources = 0;
+        size_t signal    = 0;
+    } wakeups;
+    const auto LOOPSTART = std::chrono::steady_clock::now();
 
-                m_sLoopState.wlDispatchCV.wait_for(lk, std::chrono::milliseconds(100), [this] { return m_sLoopState.wlDispatched; });
-            }
+    while (!m_bTerminate) {
+        g_pAnimationManager->beginFrame();
+
+        // Wayland wants prepare_read before blocking, which only succeeds with an empty event queue.
+        while (wl_display_prepare_read(m_sWaylandState.display) != 0) {
+            wl_display_dispatch_pending(m_sWaylandState.display);
         }
-    });
+        wl_display_flush(m_sWaylandState.display);
 
-    std::thread timersThr([this]() {
-        while (!m_bTerminate) {
-            // calc nearest thing
-            m_sLoopState.timersMutex.lock();
+        std::array<epoll_event, 8> events;
+        const int                  COUNT = epoll_wait(epollFd.get(), events.data(), events.size(), -1);
+        if (COUNT < 0) {
+            RASSERT(errno == EINTR, "[core] epoll_wait failed with {}", errno);
+            wl_display_cancel_read(m_sWaylandState.display);
+            continue;
+        }
 
-            float least = 10000;
-            for (auto& t : m_vTimers) {
-                const auto TIME = std::clamp(t->leftMs(), 1.f, INFINITY);
-                least           = std::min(TIME, least);
+        wakeups.total++;
+
+        bool wlReadable  = false;
+        bool dbusEvent   = false;
+        bool completions = false;
+        bool unlockSig   = false;
+        bool forceUpdate = false;
+        for (int i = 0; i < COUNT; ++i) {
+            const int FD = events[i].data.fd;
+            RASSERT(!(events[i].events & (EPOLLHUP | EPOLLERR)), "[core] Disconnected from fd {}", FD);
+
+            if (FD == WLFD) {
+                wlReadable = true;
+                wakeups.wayland++;
+            } else if (FD == DBUSFD) {
+                dbusEvent = true;
+                wakeups.dbus++;
+            } else if (FD == COMPLETIONFD) {
+                completions = true;
+                wakeups.resources++;
+            } else if (FD == timerFd.get()) {
+                wakeups.timer++;
+                uint64_t expirations = 0;
+                if (read(FD, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+                    Debug::log(ERR, "[core] Reading the timerfd failed with {}", errno);
+            } else if (FD == m_sLoopState.timerWakeupFd.get()) {
+                wakeups.timer++;
+                eventfd_t value = 0;
+                eventfd_read(FD, &value);
+            } else if (FD == signalFd.get()) {
+                wakeups.signal++;
+                signalfd_siginfo info;
+                while (read(FD, &info, sizeof(info)) == sizeof(info)) {
+                    unlockSig   = unlockSig || info.ssi_signo == SIGUSR1;
+                    forceUpdate = forceUpdate || info.ssi_signo == SIGUSR2;
+                }
             }
-
-            m_sLoopState.timersMutex.unlock();
-
-            std::unique_lock lk(m_sLoopState.timerRequestMutex);
-            m_sLoopState.timerCV.wait_for(lk, std::chrono::milliseconds((int)least + 1), [this] { return m_sLoopState.timerEvent; });
-            m_sLoopState.timerEvent = false;
-
-            // notify main
-            std::lock_guard<std::mutex> lg2(m_sLoopState.eventLoopMutex);
-            Debug::log(TRACE, "timer thread firing");
-            m_sLoopState.event = true;
-            m_sLoopState.loopCV.notify_all();
         }
-    });
 
-    m_sLoopState.event = true; // let it process once
-    g_pRenderer->startFadeIn();
-
-    while (!m_bTerminate) {
-        std::unique_lock lk(m_sLoopState.eventRequestMutex);
-        if (!m_sLoopState.event)
-            m_sLoopState.loopCV.wait_for(lk, std::chrono::milliseconds(5000), [this] { return m_sLoopState.event; });
-
-        if (m_bTerminate)
-            break;
-
-        std::lock_guard<std::mutex> lg(m_sLoopState.eventLoopMutex);
-
-        m_sLoopState.event = false;
+        if (wlReadable)
+            wl_display_read_events(m_sWaylandState.display);
+        else
+            wl_display_cancel_read(m_sWaylandState.display);
 
         wl_display_dispatch_pending(m_sWaylandState.display);
-        wl_display_flush(m_sWaylandState.display);
-
-        m_sLoopState.wlDispatched = true;
-        m_sLoopState.wlDispatchCV.notify_all();
 
-        if (pollfds[1].revents & POLLIN /* dbus */) {
-            while (dbusConn && dbusConn->processPendingEvent()) {
+        if (dbusEvent) {
+            while (dbusConn->processPendingEvent()) {
                 ;
             }
         }
 
+        if (unlockSig) {
+            Debug::log(LOG, "Unlocking with a SIGUSR1");
+            g_pAuth->enqueueUnlock();
+        }
+
+        if (forceUpdate)
+            forceUpdateTimers();
+
+        // Finished resource jobs don't go through the timers, so workers never touch timersMutex.
+        if (completions)
+            g_asyncResourceManager->processCompletions();
+
         processTimers();
+        armTimerFd(timerFd.get());
     }
 
+    const auto MINUTES = std::chrono::duration<float, std::ratio<60>>(std::chrono::steady_clock::now() - LOOPSTART).count();
+    Debug::log(LOG, "[core] Woke up {} times in {:.1f} minutes ({:.2f}/min): wayland {}, timer {}, dbus {}, resources {}, signal {}", wakeups.total, MINUTES,
+               MINUTES > 0 ? wakeups.total / MINUTES : 0.F, wakeups.wayland, wakeups.timer, wakeups.dbus, wakeups.resources, wakeups.signal);
+
     const auto DPY = m_sWaylandState.display;
 
-    m_sLoopState.timerEvent = true;
-    m_sLoopState.timerCV.notify_all();
     m_sWaylandState = {};
     dma             = {};
 
     m_vOutputs.clear();
     g_pSeatManager.reset();
     g_asyncResourceManager.reset();
+    g_pGPUWorker.reset();
     g_pRenderer.reset();
     g_pEGL.reset();
 
     wl_display_disconnect(DPY);
 
-    pthread_kill(pollThr.native_handle(), SIGRTMIN);
-
     g_pAuth->terminate();
 
-    // wait for threads to exit cleanly to avoid a coredump
-    pollThr.join();
-    timersThr.join();
-
     Debug::log(LOG, "Reached the end, exiting");
 }
 
@@ -828,61 +868,113 @@ size_t CHyprlock::getPasswordBufferDisplayLen() {
     return std::count_if(m_sPasswordState.passBuffer.begin(), m_sPasswordState.passBuffer.end(), [](char c) { return (c & 0xc0) != 0x80; });
 }
 
-ASP<CTimer> CHyprlock::addTimer(const std::chrono::system_clock::duration& timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data, bool force) {
+ASP<CTimer> CHyprlock::addTimer(const std::chrono::steady_clock::duration& timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data, bool force) {
+    const auto T = makeAtomicShared<CTimer>(timeout, cb_, data, force);
+
     std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
-    const auto                  T = m_vTimers.emplace_back(makeAtomicShared<CTimer>(timeout, cb_, data, force));
-    m_sLoopState.timerEvent       = true;
-    m_sLoopState.timerCV.notify_all();
+    m_timers.push(T);
+
+    // The loops rearm after every iteration, so timers added while handling events are picked up without a wakeup.
+    if (std::this_thread::get_id() != m_sLoopState.loopThread && m_sLoopState.timerWakeupFd.isValid())
+        eventfd_write(m_sLoopState.timerWakeupFd.get(), 1);
+
     return T;
 }
 
+void CHyprlock::removeTimer(CTimer* timer) {
+    std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
+    m_timers.remove(timer);
+}
+
 void CHyprlock::processTimers() {
-    // do timers
+    // Take everything that is due first. Callbacks may add or cancel timers.
+    const auto               NOW = std::chrono::steady_clock::now();
+    std::vector<ASP<CTimer>> passed;
+
     m_sLoopState.timersMutex.lock();
-    auto timerscpy = m_vTimers;
+    while (!m_timers.empty() && m_timers.top()->hasDeadline() && m_timers.top()->expiry() <= NOW) {
+        passed.emplace_back(m_timers.pop());
+    }
     m_sLoopState.timersMutex.unlock();
 
-    std::vector<ASP<CTimer>> passed;
-
-    for (auto& t : timerscpy) {
-        if (t->passed() && !t->cancelled()) {
+    for (auto& t : passed) {
+        if (!t->cancelled())
             t->call(t);
-            passed.push_back(t);
-        }
-
-        if (t->cancelled())
-            passed.push_back(t);
     }
+}
 
-    m_sLoopState.timersMutex.lock();
-    std::erase_if(m_vTimers, [passed](const auto& timer) { return std::find(passed.begin(), passed.end(), timer) != passed.end(); });
-    m_sLoopState.timersMutex.unlock();
+int CHyprlock::nextTimerTimeoutMs() {
+    std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
+
+    const auto                  NEXT = m_timers.top();
+    if (!NEXT || !NEXT->hasDeadline())
+        return -1;
 
-    passed.clear();
+    return (int)std::ceil(std::max(std::chrono::duration<float, std::milli>(NEXT->expiry() - std::chrono::steady_clock::now()).count(), 0.F));
+}
+
+int CHyprlock::getTimerWakeupFd() {
+    return m_sLoopState.timerWakeupFd.isValid() ? m_sLoopState.timerWakeupFd.get() : -1;
 }
 
 std::vector<ASP<CTimer>> CHyprlock::getTimers() {
-    return m_vTimers;
+    std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
+    return m_timers.timers();
+}
+
+void CHyprlock::forceUpdateTimers() {
+    for (auto& t : getTimers()) {
+        if (t->canForceUpdate()) {
+            t->call(t);
+            t->cancel();
+        }
+    }
 }
 
 void CHyprlock::enqueueForceUpdateTimers() {
-    addTimer(
-        std::chrono::milliseconds(1),
-        [](ASP<CTimer> self, void* data) {
-            for (auto& t : g_pHyprlock->getTimers()) {
-                if (t->canForceUpdate()) {
-                    t->call(t);
-                    t->cancel();
-                }
-            }
-        },
-        nullptr, false);
+    addTimer(std::chrono::milliseconds(1), [](ASP<CTimer> self, void* data) { g_pHyprlock->forceUpdateTimers(); }, nullptr, false);
+}
+
+void CHyprlock::armTimerFd(int fd) {
+    itimerspec spec = {};
+
+    m_sLoopState.timersMutex.lock();
+    // Only timers without a deadline left means the timerfd stays disarmed.
+    if (const auto NEXT = m_timers.top(); NEXT && NEXT->hasDeadline()) {
+        // steady_clock is CLOCK_MONOTONIC. A deadline in the past fires right away.
+        const auto NS         = std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(NEXT->expiry().time_since_epoch()).count(), 1);
+        spec.it_value.tv_sec  = NS / 1000000000;
+        spec.it_value.tv_nsec = NS % 1000000000;
+    }
+    m_sLoopState.timersMutex.unlock();
+
+    timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, nullptr);
 }
 
 SP<CCZwlrScreencopyManagerV1> CHyprlock::getScreencopy() {
     return m_sWaylandState.screencopy;
 }
 
+SP<CCExtImageCopyCaptureManagerV1> CHyprlock::getImageCopyCapture() {
+    return m_sWaylandState.imageCopyCapture;
+}
+
+SP<CCExtOutputImageCaptureSourceManagerV1> CHyprlock::getOutputCaptureSource() {
+    return m_sWaylandState.outputCaptureSource;
+}
+
+SP<CCZwlrOutputPowerManagerV1> CHyprlock::getOutputPowerMgr() {
+    return m_sWaylandState.outputPower;
+}
+
+SP<CCWpPresentation> CHyprlock::getPresentation() {
+    return m_sWaylandState.presentationClock == CLOCK_MONOTONIC ? m_sWaylandState.presentation : nullptr;
+}
+
+bool CHyprlock::canScreencopy() {
+    return m_sWaylandState.screencopy || (m_sWaylandState.imageCopyCapture && m_sWaylandState.outputCaptureSource);
+}
+
 SP<CCWlShm> CHyprlock::getShm() {
     return m_sWaylandState.shm;
 }
@@ -5,12 +5,18 @@
 #include "ext-session-lock-v1.hpp"
 #include "fractional-scale-v1.hpp"
 #include "wlr-screencopy-unstable-v1.hpp"
+#include "wlr-output-power-management-unstable-v1.hpp"
+#include "ext-image-capture-source-v1.hpp"
+#include "ext-image-copy-capture-v1.hpp"
 #include "linux-dmabuf-v1.hpp"
 #include "viewporter.hpp"
+#include "presentation-time.hpp"
 #include "Output.hpp"
 #include "Timer.hpp"
+#include <hyprutils/os/FileDescriptor.hpp>
 #include <vector>
-#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <optional>
 
 #include <xkbcommon/xkbcommon.h>
@@ -29,13 +35,23 @@ class CHyprlock {
     CHyprlock(const std::string& wlDisplay, const bool immediateRender, const int gracePeriod);
     ~CHyprlock();
 
+    // The event loop reads SIGUSR1 and SIGUSR2 from a signalfd, so they must be blocked in every thread.
+    // Threads inherit the mask, call this in main before anything can start one, including the EGL driver.
+    static void                blockLoopSignals();
+
     void                       run();
 
     void                       unlock();
     bool                       isUnlocked();
 
-    ASP<CTimer>                addTimer(const std::chrono::system_clock::duration& timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data, bool force = false);
+    ASP<CTimer>                addTimer(const std::chrono::steady_clock::duration& timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data, bool force = false);
+    // Called by CTimer::cancel.
+    void                       removeTimer(CTimer* timer);
     void                       processTimers();
+    // Milliseconds until the next timer is due, -1 if there are none.
+    int                        nextTimerTimeoutMs();
+    // Becomes readable when a timer was added. -1 if unavailable.
+    int                        getTimerWakeupFd();
 
     void                       enqueueForceUpdateTimers();
 
@@ -62,32 +78,41 @@ class CHyprlock {
     size_t                     getPasswordBufferLen();
     size_t                     getPasswordBufferDisplayLen();
 
-    SP<CCExtSessionLockManagerV1>    getSessionLockMgr();
-    SP<CCExtSessionLockV1>           getSessionLock();
-    SP<CCWlCompositor>               getCompositor();
-    wl_display*                      getDisplay();
-    SP<CCWpFractionalScaleManagerV1> getFractionalMgr();
-    SP<CCWpViewporter>               getViewporter();
-    SP<CCZwlrScreencopyManagerV1>    getScreencopy();
-    SP<CCWlShm>                      getShm();
+    SP<CCExtSessionLockManagerV1>              getSessionLockMgr();
+    SP<CCExtSessionLockV1>                     getSessionLock();
+    SP<CCWlCompositor>                         getCompositor();
+    wl_display*                                getDisplay();
+    SP<CCWpFractionalScaleManagerV1>           getFractionalMgr();
+    SP<CCWpViewporter>                         getViewporter();
+    SP<CCZwlrScreencopyManagerV1>              getScreencopy();
+    SP<CCWlShm>                                getShm();
+    // ext-image-copy-capture is preferred over wlr-screencopy when the compositor has both
+    SP<CCExtImageCopyCaptureManagerV1>         getImageCopyCapture();
+    SP<CCExtOutputImageCaptureSourceManagerV1> getOutputCaptureSource();
+    // Tells us when outputs get powered off. nullptr if the compositor doesn't support wlr-output-power-management.
+    SP<CCZwlrOutputPowerManagerV1>             getOutputPowerMgr();
+    // nullptr unless presentation timestamps are on CLOCK_MONOTONIC, which is what std::chrono::steady_clock uses.
+    SP<CCWpPresentation>                       getPresentation();
+    // Whether any of the two can be used
+    bool                                       canScreencopy();
 
-    int32_t                          m_iKeebRepeatRate  = 25;
-    int32_t                          m_iKeebRepeatDelay = 600;
+    int32_t                                    m_iKeebRepeatRate  = 25;
+    int32_t                                    m_iKeebRepeatDelay = 600;
 
-    xkb_layout_index_t               m_uiActiveLayout = 0;
+    xkb_layout_index_t                         m_uiActiveLayout = 0;
 
-    bool                             m_bTerminate = false;
+    bool                                       m_bTerminate = false;
 
-    bool                             m_lockAquired = false;
-    bool                             m_bLocked     = false;
+    bool                                       m_lockAquired = false;
+    bool                                       m_bLocked     = false;
 
-    bool                             m_bCapsLock = false;
-    bool                             m_bNumLock  = false;
-    bool                             m_bCtrl     = false;
+    bool                                       m_bCapsLock = false;
+    bool                                       m_bNumLock  = false;
+    bool                                       m_bCtrl     = false;
 
-    bool                             m_bImmediateRender = false;
+    bool                                       m_bImmediateRender = false;
 
-    std::string                      m_sCurrentDesktop = "";
+    std::string                                m_sCurrentDesktop = "";
 
     //
     std::chrono::system_clock::time_point m_tGraceEnds;
@@ -115,20 +140,30 @@ class CHyprlock {
         std::vector<SDMABUFModifier>   dmabufMods;
     } dma;
     gbm_device* createGBMDevice(drmDevice* dev);
+    // Whether device is the drm device dma.gbmDevice was opened on. False if there is no gbm device.
+    bool        isGBMDevice(dev_t device);
 
     void        addDmabufListener();
     void        removeDmabufListener();
 
   private:
     struct {
-        wl_display*                      display     = nullptr;
-        SP<CCWlRegistry>                 registry    = nullptr;
-        SP<CCExtSessionLockManagerV1>    sessionLock = nullptr;
-        SP<CCWlCompositor>               compositor  = nullptr;
-        SP<CCWpFractionalScaleManagerV1> fractional  = nullptr;
-        SP<CCWpViewporter>               viewporter  = nullptr;
-        SP<CCZwlrScreencopyManagerV1>    screencopy  = nullptr;
-        SP<CCWlShm>                      shm         = nullptr;
+        wl_display*                                display     = nullptr;
+        SP<CCWlRegistry>                           registry    = nullptr;
+        SP<CCExtSessionLockManagerV1>              sessionLock = nullptr;
+        SP<CCWlCompositor>                         compositor  = nullptr;
+        SP<CCWpFractionalScaleManagerV1>           fractional  = nullptr;
+        SP<CCWpViewporter>                         viewporter  = nullptr;
+        SP<CCZwlrScreencopyManagerV1>              screencopy  = nullptr;
+        SP<CCWlShm>                                shm         = nullptr;
+        // screencopy via ext-image-copy-capture
+        SP<CCExtImageCopyCaptureManagerV1>         imageCopyCapture    = nullptr;
+        SP<CCExtOutputImageCaptureSourceManagerV1> outputCaptureSource = nullptr;
+        // dpms state of the outputs
+        SP<CCZwlrOutputPowerManagerV1>             outputPower = nullptr;
+        // vblank timestamps for animations
+        SP<CCWpPresentation>                       presentation      = nullptr;
+        uint32_t                                   presentationClock = UINT32_MAX;
     } m_sWaylandState;
 
     struct {
@@ -142,23 +177,19 @@ class CHyprlock {
     } m_sPasswordState;
 
     struct {
-        std::mutex              timersMutex;
-        std::mutex              eventRequestMutex;
-        std::mutex              eventLoopMutex;
-        std::condition_variable loopCV;
-        bool                    event = false;
-
-        std::condition_variable wlDispatchCV;
-        bool                    wlDispatched = false;
-
-        std::condition_variable timerCV;
-        std::mutex              timerRequestMutex;
-        bool                    timerEvent = false;
+        std::mutex                     timersMutex;
+        // Written when a timer is added from another thread, so that the event loop and loops outside of run() wake up for it.
+        Hyprutils::OS::CFileDescriptor timerWakeupFd;
+        std::thread::id                loopThread;
     } m_sLoopState;
 
-    std::vector<ASP<CTimer>> m_vTimers;
+    CTimerQueue           m_timers;
+
+    std::vector<uint32_t> m_vPressedKeys;
 
-    std::vector<uint32_t>    m_vPressedKeys;
+    void                  forceUpdateTimers();
+    // Arms fd to the expiry of the next timer, or disarms it if there is none.
+    void                  armTimerFd(int fd);
 };
 
 inline UP<CHyprlock> g_pHyprlock;
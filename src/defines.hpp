@@ -4,12 +4,11 @@
 #include <hyprutils/memory/UniquePtr.hpp>
 #include <hyprutils/memory/Atomic.hpp>
 #include <hyprgraphics/color/Color.hpp>
+#include "helpers/ResourceID.hpp"
 
 using namespace Hyprutils::Memory;
 using namespace Hyprgraphics;
 
-using ResourceID = size_t;
-
 #define SP CSharedPointer
 #define WP CWeakPointer
 #define UP CUniquePointer
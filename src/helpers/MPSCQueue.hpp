@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Lock-free queue for many producers and a single consumer.
+// Producers push onto a Treiber stack. The consumer takes the whole stack with one exchange and reverses it, so items come out in push order.
+// Nodes are never popped one by one, which keeps it free of ABA problems.
+template <typename T>
+class CMPSCQueue {
+  public:
+    CMPSCQueue() = default;
+    ~CMPSCQueue() {
+        destroyList(m_head.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    CMPSCQueue(const CMPSCQueue&)            = delete;
+    CMPSCQueue& operator=(const CMPSCQueue&) = delete;
+
+    // Returns true if the queue was empty, so the consumer needs a wakeup.
+    bool push(T&& value) {
+        auto*  node = new SNode{.value = std::move(value)};
+        SNode* head = m_head.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!m_head.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+
+        // node belongs to the consumer now, don't touch it anymore.
+        return head == nullptr;
+    }
+
+    // Consumer only. Takes everything pushed so far, oldest first.
+    std::vector<T> drain() {
+        SNode* node     = m_head.exchange(nullptr, std::memory_order_acquire);
+        SNode* reversed = nullptr;
+        size_t count    = 0;
+        while (node) {
+            SNode* next = node->next;
+            node->next  = reversed;
+            reversed    = node;
+            node        = next;
+            count++;
+        }
+
+        std::vector<T> items;
+        items.reserve(count);
+        while (reversed) {
+            SNode* next = reversed->next;
+            items.emplace_back(std::move(reversed->value));
+            delete reversed;
+            reversed = next;
+        }
+
+        return items;
+    }
+
+  private:
+    struct SNode {
+        T      value;
+        SNode* next = nullptr;
+    };
+
+    static void destroyList(SNode* node) {
+        while (node) {
+            SNode* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    std::atomic<SNode*> m_head = nullptr;
+};
@@ -1,15 +1,18 @@
 #include <filesystem>
 #include <algorithm>
 #include <cmath>
-#include <fcntl.h>
 #include "MiscFunctions.hpp"
 #include "Log.hpp"
 #include <hyprutils/string/String.hpp>
-#include <hyprutils/os/Process.hpp>
+#include <csignal>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 using namespace Hyprutils::String;
-using namespace Hyprutils::OS;
 
 std::string absolutePath(const std::string& rawpath, const std::string& currentDir) {
     std::filesystem::path path(rawpath);
@@ -104,57 +107,114 @@ int64_t configStringToInt(const std::string& VALUE) {
     return 0;
 }
 
-int createPoolFile(size_t size, std::string& name) {
-    const auto XDGRUNTIMEDIR = getenv("XDG_RUNTIME_DIR");
-    if (!XDGRUNTIMEDIR) {
-        Debug::log(CRIT, "XDG_RUNTIME_DIR not set!");
-        return -1;
-    }
+// The event loop reads SIGUSR1/SIGUSR2 from a signalfd, so they are blocked in every thread.
+// A blocked mask survives exec, which is why commands are spawned with an empty one instead of going through fork in CProcess.
+static pid_t spawnShell(const std::vector<const char*>& args, const posix_spawn_file_actions_t* actions) {
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
 
-    name = std::string(XDGRUNTIMEDIR) + "/.hyprlock_sc_XXXXXX";
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
 
-    const auto FD = mkstemp((char*)name.c_str());
-    if (FD < 0) {
-        Debug::log(CRIT, "createPoolFile: fd < 0");
-        return -1;
-    }
-    // set cloexec
-    long flags = fcntl(FD, F_GETFD);
-    if (flags == -1) {
-        close(FD);
-        return -1;
-    }
+    std::vector<char*> argv;
+    for (const auto& a : args)
+        argv.push_back(const_cast<char*>(a));
+    argv.push_back(nullptr);
 
-    if (fcntl(FD, F_SETFD, flags | FD_CLOEXEC) == -1) {
-        close(FD);
-        Debug::log(CRIT, "createPoolFile: fcntl < 0");
-        return -1;
-    }
+    pid_t      pid = -1;
+    const auto RET = posix_spawn(&pid, "/bin/sh", actions, &attr, argv.data(), environ);
+    posix_spawnattr_destroy(&attr);
 
-    if (ftruncate(FD, size) < 0) {
-        close(FD);
-        Debug::log(CRIT, "createPoolFile: ftruncate < 0");
-        return -1;
-    }
+    return RET == 0 ? pid : -1;
+}
 
-    return FD;
+static void waitChild(pid_t pid) {
+    while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+        ;
+    }
 }
 
 std::string spawnSync(const std::string& cmd) {
-    CProcess proc("/bin/sh", {"-c", cmd});
-    if (!proc.runSync()) {
+    int outPipe[2] = {-1, -1};
+    int errPipe[2] = {-1, -1};
+    if (pipe2(outPipe, O_CLOEXEC) < 0 || pipe2(errPipe, O_CLOEXEC) < 0) {
+        Debug::log(ERR, "Failed to run \"{}\": pipe2 failed", cmd);
+        for (const auto fd : {outPipe[0], outPipe[1], errPipe[0], errPipe[1]}) {
+            if (fd >= 0)
+                close(fd);
+        }
+        return "";
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+
+    const auto PID = spawnShell({"/bin/sh", "-c", cmd.c_str()}, &actions);
+    posix_spawn_file_actions_destroy(&actions);
+    close(outPipe[1]);
+    close(errPipe[1]);
+
+    if (PID < 0) {
         Debug::log(ERR, "Failed to run \"{}\"", cmd);
+        close(outPipe[0]);
+        close(errPipe[0]);
         return "";
     }
 
-    if (!proc.stdErr().empty())
-        Debug::log(ERR, "Shell command \"{}\" STDERR:\n{}", cmd, proc.stdErr());
+    std::string   stdOut;
+    std::string   stdErr;
+    struct pollfd pollfds[] = {
+        {.fd = outPipe[0], .events = POLLIN, .revents = 0},
+        {.fd = errPipe[0], .events = POLLIN, .revents = 0},
+    };
+    std::string* outputs[] = {&stdOut, &stdErr};
+    char         buf[1024];
+
+    while (pollfds[0].fd >= 0 || pollfds[1].fd >= 0) {
+        if (poll(pollfds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (size_t i = 0; i < 2; ++i) {
+            if (pollfds[i].fd < 0 || pollfds[i].revents == 0)
+                continue;
+
+            const auto LEN = read(pollfds[i].fd, buf, sizeof(buf));
+            if (LEN > 0)
+                outputs[i]->append(buf, LEN);
+            else if (LEN == 0 || errno != EINTR) {
+                close(pollfds[i].fd);
+                pollfds[i].fd = -1;
+            }
+        }
+    }
 
-    return proc.stdOut();
+    for (const auto& pfd : pollfds) {
+        if (pfd.fd >= 0)
+            close(pfd.fd);
+    }
+
+    waitChild(PID);
+
+    if (!stdErr.empty())
+        Debug::log(ERR, "Shell command \"{}\" STDERR:\n{}", cmd, stdErr);
+
+    return stdOut;
 }
 
 void spawnAsync(const std::string& cmd) {
-    CProcess proc("/bin/sh", {"-c", cmd});
-    if (!proc.runAsync())
+    // The intermediate shell backgrounds the command and exits right away, so there is nothing left to reap.
+    const auto PID = spawnShell({"/bin/sh", "-c", "/bin/sh -c \"$1\" &", "/bin/sh", cmd.c_str()}, nullptr);
+    if (PID < 0) {
         Debug::log(ERR, "Failed to start \"{}\"", cmd);
+        return;
+    }
+
+    waitChild(PID);
 }
@@ -0,0 +1,49 @@
+#include "ResourceID.hpp"
+#include <bit>
+#include <cstring>
+
+// FNV-1a 128 bit parameters
+constexpr __uint128_t FNV128_OFFSET = ((__uint128_t)0x6c62272e07bb0142ULL << 64) | 0x62b821756295c58dULL;
+constexpr __uint128_t FNV128_PRIME  = ((__uint128_t)0x0000000001000000ULL << 64) | 0x000000000000013bULL;
+
+CResourceKey::CResourceKey(uint8_t scope) {
+    m_key.push_back((char)scope);
+}
+
+CResourceKey& CResourceKey::addString(const std::string& s) {
+    // Length prefixed, so that ("ab", "c") and ("a", "bc") differ.
+    addInt((int64_t)s.size());
+    m_key.append(s);
+    return *this;
+}
+
+CResourceKey& CResourceKey::addInt(int64_t v) {
+    char buf[sizeof(v)];
+    std::memcpy(buf, &v, sizeof(v));
+    m_key.append(buf, sizeof(buf));
+    return *this;
+}
+
+CResourceKey& CResourceKey::addFloat(double v) {
+    return addInt(std::bit_cast<int64_t>(v == 0.0 ? 0.0 : v)); // -0.0 == 0.0
+}
+
+ResourceID CResourceKey::id() const {
+    __uint128_t hash = FNV128_OFFSET;
+    for (const auto C : m_key) {
+        hash ^= (uint8_t)C;
+        hash *= FNV128_PRIME;
+    }
+
+    ResourceID id = {.hi = (uint64_t)(hash >> 64), .lo = (uint64_t)hash};
+    return id ? id : ResourceID{.hi = 0, .lo = 1};
+}
+
+const std::string& CResourceKey::str() const {
+    return m_key;
+}
+
+ResourceID CResourceKey::probe(const ResourceID& id) {
+    ResourceID next = {.hi = id.hi, .lo = id.lo + 0x9e3779b97f4a7c15ULL};
+    return next ? next : ResourceID{.hi = 0, .lo = 1};
+}
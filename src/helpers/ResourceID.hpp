@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <string>
+
+// 128 bit id of an asset. Zero means none.
+struct SResourceID {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    bool     operator==(const SResourceID&) const = default;
+    explicit operator bool() const {
+        return hi || lo;
+    }
+};
+
+using ResourceID = SResourceID;
+
+// Serializes the parameters of a resource request without ambiguity.
+// The resource id is a 128 bit FNV-1a hash of the key, the resource manager still compares the full key on lookup.
+class CResourceKey {
+  public:
+    explicit CResourceKey(uint8_t scope);
+
+    CResourceKey&      addString(const std::string& s);
+    CResourceKey&      addInt(int64_t v);
+    CResourceKey&      addFloat(double v);
+
+    ResourceID         id() const;
+    const std::string& str() const;
+
+    // Derives the next id to try, when id is already taken by a different key.
+    static ResourceID probe(const ResourceID& id);
+
+  private:
+    std::string m_key;
+};
+
+template <>
+struct std::hash<SResourceID> {
+    size_t operator()(const SResourceID& id) const noexcept {
+        return id.lo ^ (id.hi * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+template <>
+struct std::formatter<SResourceID> : std::formatter<std::string> {
+    auto format(const SResourceID& id, std::format_context& ctx) const {
+        return std::formatter<std::string>::format(std::format("{:016x}{:016x}", id.hi, id.lo), ctx);
+    }
+};
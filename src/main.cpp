@@ -38,6 +38,8 @@ static void printVersion() {
 }
 
 int main(int argc, char** argv, char** envp) {
+    CHyprlock::blockLoopSignals();
+
     std::string              configPath;
     std::string              wlDisplay;
     bool                     immediateRender = false;
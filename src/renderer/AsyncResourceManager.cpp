@@ -1,6 +1,6 @@
 #include "AsyncResourceManager.hpp"
 
-#include "./resources/TextCmdResource.hpp"
+#include "./resources/SizedImageResource.hpp"
 #include "../helpers/Log.hpp"
 #include "../helpers/MiscFunctions.hpp"
 #include "../core/hyprlock.hpp"
@@ -11,86 +11,120 @@
 #include <functional>
 #include <sys/eventfd.h>
 #include <sys/poll.h>
+#include <thread>
+#include <utility>
 
 using namespace Hyprgraphics;
 using namespace Hyprutils::OS;
 
-static inline ResourceID scopeResourceID(uint8_t scope, size_t in) {
-    return (in & ~0x0f) | scope;
+enum eResourceScope : uint8_t {
+    RESOURCE_SCOPE_TEXT = 1,
+    RESOURCE_SCOPE_TEXT_CMD,
+    RESOURCE_SCOPE_IMAGE,
+    RESOURCE_SCOPE_SCREENCOPY,
+};
+
+static CResourceKey& addTextRequest(CResourceKey& key, const CTextResource::STextResourceData& s) {
+    // Pango markup is part of the text.
+    const auto RGB = s.color.asRgb();
+    return key.addString(s.text).addString(s.font).addInt(s.fontSize).addFloat(RGB.r).addFloat(RGB.g).addFloat(RGB.b).addInt(s.align);
 }
 
-ResourceID CAsyncResourceManager::resourceIDForTextRequest(const CTextResource::STextResourceData& s) {
-    // TODO: Currently ignores the font string and resulting distribution is probably not perfect.
-    const auto H1 = std::hash<std::string>{}(s.text);
-    const auto H2 = std::hash<double>{}(s.color.asRgb().r);
-    const auto H3 = std::hash<double>{}(s.color.asRgb().g) + s.fontSize;
-    const auto H4 = std::hash<double>{}(s.color.asRgb().b) + s.align;
+CResourceKey CAsyncResourceManager::resourceKeyForTextRequest(const CTextResource::STextResourceData& s) {
+    CResourceKey key{RESOURCE_SCOPE_TEXT};
+    return addTextRequest(key, s);
+}
+
+CResourceKey CAsyncResourceManager::resourceKeyForTextCmdRequest(const CTextResource::STextResourceData& s, size_t revision) {
+    CResourceKey key{RESOURCE_SCOPE_TEXT_CMD};
+    return addTextRequest(key, s).addInt(revision);
+}
 
-    return scopeResourceID(1, H1 ^ (H2 << 1) ^ (H3 << 2) ^ (H4 << 3));
+CResourceKey CAsyncResourceManager::resourceKeyForImageRequest(const std::string& path, size_t revision, const Vector2D& targetSize) {
+    CResourceKey key{RESOURCE_SCOPE_IMAGE};
+    return key.addString(path).addInt(revision).addFloat(targetSize.x).addFloat(targetSize.y);
 }
 
-ResourceID CAsyncResourceManager::resourceIDForTextCmdRequest(const CTextResource::STextResourceData& s, size_t revision) {
-    return scopeResourceID(2, resourceIDForTextRequest(s) ^ (revision << 32));
+CResourceKey CAsyncResourceManager::resourceKeyForScreencopy(const std::string& port) {
+    CResourceKey key{RESOURCE_SCOPE_SCREENCOPY};
+    return key.addString(port);
+}
+
+// general:resource_workers, 0 picks one worker per core.
+static size_t resourceWorkerCount() {
+    static const auto WORKERS = g_pConfigManager->getValue<Hyprlang::INT>("general:resource_workers");
+
+    if (*WORKERS > 0)
+        return *WORKERS;
+
+    return std::max(std::thread::hardware_concurrency(), 1U);
 }
 
-ResourceID CAsyncResourceManager::resourceIDForImageRequest(const std::string& path, size_t revision) {
-    return scopeResourceID(3, std::hash<std::string>{}(path) ^ (revision << 32));
+CAsyncResourceManager::CAsyncResourceManager() : m_jobQueue(resourceWorkerCount()) {
+    ;
 }
 
 ResourceID CAsyncResourceManager::resourceIDForScreencopy(const std::string& port) {
-    return scopeResourceID(4, std::hash<std::string>{}(port));
+    return resourceKeyForScreencopy(port).id();
 }
 
-ResourceID CAsyncResourceManager::requestText(const CTextResource::STextResourceData& params, const AWP<IWidget>& widget) {
-    const auto RESOURCEID = resourceIDForTextRequest(params);
-    if (request(RESOURCEID, widget)) {
+CResourceHandle CAsyncResourceManager::requestText(const CTextResource::STextResourceData& params, const AWP<IWidget>& widget, eResourcePriority priority) {
+    const auto      KEY        = resourceKeyForTextRequest(params);
+    const auto      RESOURCEID = lookup(KEY);
+    CResourceHandle handle;
+    if (request(RESOURCEID, KEY, widget, handle)) {
         Debug::log(TRACE, "Reusing text resource \"{}\" (resourceID: {})", params.text, RESOURCEID, (uintptr_t)widget.get());
-        return RESOURCEID;
+        return handle;
     }
 
     auto                                 resource = makeAtomicShared<CTextResource>(CTextResource::STextResourceData{params});
     CAtomicSharedPointer<IAsyncResource> resourceGeneric{resource};
 
     Debug::log(TRACE, "Requesting text resource \"{}\" (resourceID: {})", params.text, RESOURCEID, (uintptr_t)widget.get());
-    enqueue(RESOURCEID, resourceGeneric, widget);
-    return RESOURCEID;
+    enqueue(RESOURCEID, resourceGeneric, widget, priority);
+    return handle;
 }
 
-ResourceID CAsyncResourceManager::requestTextCmd(const CTextResource::STextResourceData& params, size_t revision, const AWP<IWidget>& widget) {
-    const auto RESOURCEID = resourceIDForTextCmdRequest(params, revision);
-    if (request(RESOURCEID, widget)) {
+CResourceHandle CAsyncResourceManager::requestTextCmd(const CTextResource::STextResourceData& params, size_t revision, const AWP<IWidget>& widget,
+                                                      const ASP<STextCmdOutput>& lastOutput) {
+    const auto      KEY        = resourceKeyForTextCmdRequest(params, revision);
+    const auto      RESOURCEID = lookup(KEY);
+    CResourceHandle handle;
+    if (request(RESOURCEID, KEY, widget, handle)) {
         Debug::log(TRACE, "Reusing text cmd resource \"{}\" revision {} (resourceID: {})", params.text, revision, RESOURCEID, (uintptr_t)widget.get());
-        return RESOURCEID;
+        return handle;
     }
 
-    auto                                 resource = makeAtomicShared<CTextCmdResource>(CTextResource::STextResourceData{params});
+    auto                                 resource = makeAtomicShared<CTextCmdResource>(CTextResource::STextResourceData{params}, lastOutput);
     CAtomicSharedPointer<IAsyncResource> resourceGeneric{resource};
 
     Debug::log(TRACE, "Requesting text cmd resource \"{}\" revision {} (resourceID: {})", params.text, revision, RESOURCEID, (uintptr_t)widget.get());
-    enqueue(RESOURCEID, resourceGeneric, widget);
-    return RESOURCEID;
+    enqueue(RESOURCEID, resourceGeneric, widget, RESOURCE_PRIORITY_DYNAMIC);
+    return handle;
 }
 
-ResourceID CAsyncResourceManager::requestImage(const std::string& path, size_t revision, const AWP<IWidget>& widget) {
-    const auto RESOURCEID = resourceIDForImageRequest(path, revision);
-    if (request(RESOURCEID, widget)) {
-        Debug::log(TRACE, "Reusing image resource {} revision {} (resourceID: {})", path, revision, RESOURCEID, (uintptr_t)widget.get());
-        return RESOURCEID;
+CResourceHandle CAsyncResourceManager::requestImage(const std::string& path, size_t revision, const Vector2D& targetSize, const AWP<IWidget>& widget, eResourcePriority priority) {
+    const auto      KEY        = resourceKeyForImageRequest(path, revision, targetSize);
+    const auto      RESOURCEID = lookup(KEY);
+    CResourceHandle handle;
+    if (request(RESOURCEID, KEY, widget, handle)) {
+        Debug::log(TRACE, "Reusing image resource {} revision {} target {} (resourceID: {})", path, revision, targetSize, RESOURCEID, (uintptr_t)widget.get());
+        return handle;
     }
 
-    auto                                 resource = makeAtomicShared<CImageResource>(absolutePath(path, ""));
+    auto                                 resource = makeAtomicShared<CSizedImageResource>(absolutePath(path, ""), targetSize);
     CAtomicSharedPointer<IAsyncResource> resourceGeneric{resource};
 
-    Debug::log(TRACE, "Requesting image resource {} revision {} (resourceID: {})", path, revision, RESOURCEID, (uintptr_t)widget.get());
-    enqueue(RESOURCEID, resourceGeneric, widget);
-    return RESOURCEID;
+    Debug::log(TRACE, "Requesting image resource {} revision {} target {} (resourceID: {})", path, revision, targetSize, RESOURCEID, (uintptr_t)widget.get());
+    enqueue(RESOURCEID, resourceGeneric, widget, priority);
+    return handle;
 }
 
-ASP<CTexture> CAsyncResourceManager::getAssetByID(size_t id) {
+CResourceHandle CAsyncResourceManager::acquire(ResourceID id) {
     if (!m_assets.contains(id))
-        return nullptr;
+        return {};
 
-    return m_assets[id].texture;
+    return makeHandle(m_assets[id]);
 }
 
 void CAsyncResourceManager::enqueueStaticAssets() {
@@ -103,13 +137,47 @@ void CAsyncResourceManager::enqueueStaticAssets() {
             if (path.empty() || path == "screenshot")
                 continue;
 
-            requestImage(path, 0, nullptr);
+            if (c.type == "image") {
+                const double SIZE = std::any_cast<Hyprlang::INT>(c.values.at("size"));
+                m_persistent.emplace_back(requestImage(path, 0, Vector2D{SIZE, SIZE}, nullptr, RESOURCE_PRIORITY_STATIC));
+                continue;
+            }
+
+            // Backgrounds are sized per output. Outputs with the same mode share the request.
+            for (const auto& MON : g_pHyprlock->m_vOutputs) {
+                if (!MON->matchesMonitor(c.monitor))
+                    continue;
+
+                auto& handle = m_persistent.emplace_back(requestImage(path, 0, MON->size, nullptr, RESOURCE_PRIORITY_BACKGROUND));
+                m_critical.insert(handle.id());
+            }
         }
     }
 }
 
+// A screenshot that only ever gets blurred or faded out doesn't need all of its pixels.
+constexpr float SCREENCOPY_REDUCED_SCALE = 0.5F;
+
+// Returns 0 if no background on the output uses the screenshot, otherwise the scale to keep it at.
+static float screencopyScaleFor(const SP<COutput>& output, const std::vector<CConfigManager::SWidgetConfig>& widgets, bool fadeNeedsSc) {
+    float scale = 0.F;
+    for (const auto& c : widgets) {
+        if (c.type != "background" || !output->matchesMonitor(c.monitor))
+            continue;
+
+        const bool SCREENSHOT = std::string{std::any_cast<Hyprlang::STRING>(c.values.at("path"))} == "screenshot";
+        if (SCREENSHOT && std::any_cast<Hyprlang::INT>(c.values.at("blur_passes")) <= 0)
+            return 1.F; // drawn as is
+
+        if (SCREENSHOT || fadeNeedsSc)
+            scale = SCREENCOPY_REDUCED_SCALE;
+    }
+
+    return scale;
+}
+
 void CAsyncResourceManager::enqueueScreencopyFrames() {
-    if (g_pHyprlock->m_vOutputs.empty())
+    if (g_pHyprlock->m_vOutputs.empty() || !g_pHyprlock->canScreencopy())
         return;
 
     static const auto ANIMATIONSENABLED = g_pConfigManager->getValue<Hyprlang::INT>("animations:enabled");
@@ -121,20 +189,21 @@ void CAsyncResourceManager::enqueueScreencopyFrames() {
         ((FADEINCFG->pValues && FADEINCFG->pValues->internalEnabled) || // fadeIn or fadeOut enabled
          (FADEOUTCFG->pValues && FADEOUTCFG->pValues->internalEnabled));
 
-    const auto BGSCREENSHOT = std::ranges::any_of(g_pConfigManager->getWidgetConfigs(), [](const auto& w) { //
-        return w.type == "background" && std::string{std::any_cast<Hyprlang::STRING>(w.values.at("path"))} == "screenshot";
-    });
-
-    if (!BGSCREENSHOT && !FADENEEDSSC) {
-        Debug::log(LOG, "Skipping screencopy");
-        return;
-    }
+    const auto CWIDGETS = g_pConfigManager->getWidgetConfigs();
 
     for (const auto& MON : g_pHyprlock->m_vOutputs) {
+        const auto SCALE = screencopyScaleFor(MON, CWIDGETS, FADENEEDSSC);
+        if (SCALE <= 0.F) {
+            Debug::log(LOG, "Skipping screencopy for {}", MON->stringPort);
+            continue;
+        }
+
         m_scFrames.emplace_back(makeUnique<CScreencopyFrame>());
         auto* frame = m_scFrames.back().get();
-        frame->capture(MON);
-        m_assets.emplace(frame->m_resourceID, SPreloadedTexture{.texture = nullptr, .refs = 1});
+        frame->capture(MON, SCALE);
+        if (!m_assets.contains(frame->m_resourceID))
+            m_persistent.emplace_back(makeHandle(allocSlot(frame->m_resourceID, resourceKeyForScreencopy(MON->stringPort))));
+        m_critical.insert(frame->m_resourceID);
     }
 }
 
@@ -144,115 +213,215 @@ void CAsyncResourceManager::screencopyToTexture(const CScreencopyFrame& scFrame)
         return;
     }
 
-    m_assets[scFrame.m_resourceID].texture = scFrame.m_asset;
+    m_slots[m_assets[scFrame.m_resourceID]].texture = scFrame.m_asset;
+    resolveCritical(scFrame.m_resourceID);
 
     Debug::log(TRACE, "Done sc frame {}", scFrame.m_resourceID);
 
+    removeScreencopyFrame(scFrame);
+}
+
+void CAsyncResourceManager::screencopyFailed(const CScreencopyFrame& scFrame) {
+    Debug::log(ERR, "Screencopy frame {} failed", scFrame.m_resourceID);
+
+    resolveCritical(scFrame.m_resourceID);
+    removeScreencopyFrame(scFrame);
+}
+
+void CAsyncResourceManager::removeScreencopyFrame(const CScreencopyFrame& scFrame) {
     std::erase_if(m_scFrames, [&scFrame](const auto& f) { return f.get() == &scFrame; });
 
     if (m_scFrames.empty()) {
         Debug::log(LOG, "Gathered all screencopy frames - removing dmabuf listeners");
         g_pHyprlock->removeDmabufListener();
+        // Don't keep a copy of every output in memory for the whole session.
+        m_shmPool.trim();
+        m_dmaPool.trim();
     }
 }
 
 void CAsyncResourceManager::gatherInitialResources(wl_display* display) {
-    const auto MAXDELAYMS    = 2000; // 2 Seconds
-    const auto STARTGATHERTP = std::chrono::system_clock::now();
+    static const auto GATHERTIMEOUT = g_pConfigManager->getValue<Hyprlang::INT>("general:gather_timeout");
+
+    const auto        STARTGATHERTP = std::chrono::steady_clock::now();
+    const auto        DEADLINE      = STARTGATHERTP + std::chrono::milliseconds(*GATHERTIMEOUT);
 
-    m_gatheredEventfd = CFileDescriptor{eventfd(0, EFD_CLOEXEC)};
+    // Timers added from other threads wake us up through this.
+    const auto WAKEUPFD = g_pHyprlock->getTimerWakeupFd();
 
-    int    fdcount = 1;
-    pollfd pollfds[2];
+    int        fdcount = 2;
+    pollfd     pollfds[3];
     pollfds[0] = {
         .fd     = wl_display_get_fd(display),
         .events = POLLIN,
     };
+    pollfds[1] = {
+        .fd     = completionFd(),
+        .events = POLLIN,
+    };
 
-    if (m_gatheredEventfd.isValid()) {
-        pollfds[1] = {
-            .fd     = m_gatheredEventfd.get(),
+    if (WAKEUPFD >= 0) {
+        pollfds[2] = {
+            .fd     = WAKEUPFD,
             .events = POLLIN,
         };
 
         fdcount++;
     }
 
-    bool gathered = false;
-    while (!gathered) {
+    m_gathered = m_critical.empty();
+    while (!m_gathered) {
+        const auto NOW = std::chrono::steady_clock::now();
+        if (NOW >= DEADLINE) {
+            Debug::log(WARN, "Gathering resources timed out after {} milliseconds with {} critical resources missing. Backgrounds may render `background:color` at first.",
+                       *GATHERTIMEOUT, m_critical.size());
+            break;
+        }
+
+        // Sleep until something happens or the next timer is due. Without a wakeup fd we can't know when a timer gets added.
+        int       timeout     = std::chrono::ceil<std::chrono::milliseconds>(DEADLINE - NOW).count();
+        const int NEXTTIMERMS = g_pHyprlock->nextTimerTimeoutMs();
+        if (NEXTTIMERMS >= 0)
+            timeout = std::min(timeout, NEXTTIMERMS);
+        if (WAKEUPFD < 0)
+            timeout = std::min(timeout, 10);
+
         wl_display_flush(display);
         if (wl_display_prepare_read(display) == 0) {
-            if (poll(pollfds, fdcount, /* 100ms timeout */ 100) < 0) {
+            if (poll(pollfds, fdcount, timeout) < 0) {
                 RASSERT(errno == EINTR, "[core] Polling fds failed with {}", errno);
                 wl_display_cancel_read(display);
                 continue;
             }
             wl_display_read_events(display);
-            wl_display_dispatch_pending(display);
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            wl_display_dispatch(display);
         }
 
-        g_pHyprlock->processTimers();
+        wl_display_dispatch_pending(display);
 
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - STARTGATHERTP).count() > MAXDELAYMS) {
-            Debug::log(WARN, "Gathering resources timed out after {} milliseconds. Backgrounds may be delayed and render `background:color` at first.", MAXDELAYMS);
-            break;
+        if (pollfds[1].revents & POLLIN)
+            processCompletions();
+
+        if (fdcount > 2 && (pollfds[2].revents & POLLIN)) {
+            eventfd_t val = 0;
+            eventfd_read(WAKEUPFD, &val);
         }
 
-        gathered = m_resources.empty() && m_scFrames.empty();
+        g_pHyprlock->processTimers();
     }
 
-    Debug::log(LOG, "Resources gathered after {} milliseconds", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - STARTGATHERTP).count());
+    m_gathered = true;
+
+    Debug::log(LOG, "Critical resources gathered after {} milliseconds, {} other resources still loading",
+               std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - STARTGATHERTP).count(), m_resources.size());
+}
+
+void CAsyncResourceManager::resolveCritical(ResourceID id) {
+    if (!m_critical.erase(id))
+        return;
+
+    Debug::log(TRACE, "Critical resource {} resolved, {} left", id, m_critical.size());
+
+    if (m_critical.empty())
+        m_gathered = true;
 }
 
-bool CAsyncResourceManager::checkIdPresent(ResourceID id) {
-    return m_assets.contains(id);
+ASP<CTexture> CAsyncResourceManager::textureForSlot(uint32_t slot) {
+    return m_slots[slot].texture;
 }
 
-void CAsyncResourceManager::unload(ASP<CTexture> texture) {
-    auto preload = std::ranges::find_if(m_assets, [texture](const auto& a) { return a.second.texture == texture; });
-    if (preload == m_assets.end())
+void CAsyncResourceManager::release(uint32_t slot) {
+    auto& asset = m_slots[slot];
+    RASSERT(asset.refs > 0, "Released an asset slot without references");
+
+    if (--asset.refs > 0)
         return;
 
-    preload->second.refs--;
+    const auto ID = asset.id;
+    Debug::log(TRACE, "Releasing resourceID: {}!", ID);
+
+    m_assets.erase(ID);
+    m_texturePool.put(std::move(asset.texture));
+    asset = {};
+    m_freeSlots.push_back(slot);
 
-    if (preload->second.refs == 0) {
-        Debug::log(TRACE, "Releasing resourceID: {}!", preload->first);
-        m_assets.erase(preload->first);
+    onReleased(ID);
+}
+
+CResourceHandle CAsyncResourceManager::makeHandle(uint32_t slot) {
+    m_slots[slot].refs++;
+    return CResourceHandle{m_slots[slot].id, slot};
+}
+
+uint32_t CAsyncResourceManager::allocSlot(ResourceID id, const CResourceKey& key) {
+    uint32_t slot = 0;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = m_slots.size();
+        m_slots.emplace_back();
     }
+
+    m_slots[slot] = {.id = id, .texture = nullptr, .refs = 0, .key = key.str()};
+    m_assets[id]  = slot;
+    return slot;
 }
 
-void CAsyncResourceManager::unloadById(ResourceID id) {
-    if (!m_assets.contains(id))
+bool CAsyncResourceManager::cancelRequest(CResourceHandle& handle, const AWP<IWidget>& widget) {
+    const auto ID = handle.id();
+
+    m_resourcesMutex.lock();
+    if (!m_resources.contains(ID) || !m_jobQueue.queued(ID)) {
+        m_resourcesMutex.unlock();
+        return false;
+    }
+
+    std::erase_if(m_resources[ID].second, [&widget](const auto& w) { return w.get() == widget.get(); });
+    m_resourcesMutex.unlock();
+
+    Debug::log(TRACE, "Cancelling request for resourceID: {}", ID);
+    handle.reset();
+    return true;
+}
+
+void CAsyncResourceManager::onReleased(ResourceID id) {
+    m_resourcesMutex.lock();
+    const bool INFLIGHT = m_resources.erase(id) > 0;
+    m_resourcesMutex.unlock();
+
+    if (!INFLIGHT)
         return;
 
-    m_assets[id].refs--;
+    // If the job already started, onResourceFinished drops the result.
+    m_jobQueue.cancel(id);
+    resolveCritical(id);
+}
 
-    if (m_assets[id].refs == 0) {
-        Debug::log(TRACE, "Releasing resourceID: {}!", id);
-        m_assets.erase(id);
+ResourceID CAsyncResourceManager::lookup(const CResourceKey& key) {
+    auto id = key.id();
+    while (m_assets.contains(id) && m_slots[m_assets[id]].key != key.str()) {
+        Debug::log(WARN, "resourceID: {} is taken by a different request, probing", id);
+        id = CResourceKey::probe(id);
     }
+
+    return id;
 }
 
-bool CAsyncResourceManager::request(ResourceID id, const AWP<IWidget>& widget) {
+bool CAsyncResourceManager::request(ResourceID id, const CResourceKey& key, const AWP<IWidget>& widget, CResourceHandle& handle) {
     if (!m_assets.contains(id)) {
         // New asset!!
-        m_assets.emplace(id, SPreloadedTexture{.texture = nullptr, .refs = 1});
+        handle = makeHandle(allocSlot(id, key));
         return false;
     }
 
-    m_assets[id].refs++;
+    const auto SLOT = m_assets[id];
+    handle          = makeHandle(SLOT);
 
-    if (m_assets[id].texture) {
-        // Asset already present. Dispatch the asset callback function.
-        const auto& TEXTURE = m_assets[id].texture;
-        if (widget)
-            widget->onAssetUpdate(id, TEXTURE);
-
-        // TODO: add a centalized mechanism to render in one place in the event loop to avoid duplicate render calls
-        g_pHyprlock->addTimer(std::chrono::milliseconds(0), [](auto, auto) { g_pHyprlock->renderAllOutputs(); }, nullptr);
+    if (const auto TEXTURE = m_slots[SLOT].texture; TEXTURE) {
+        // Asset already present. Dispatch the asset callback function once the caller got the handle.
+        // Goes through the same render as finished jobs, so many cache hits in one iteration render once.
+        m_cacheHits.emplace_back(SCacheHit{.id = id, .texture = TEXTURE, .widget = widget});
+        scheduleRender();
     } else if (widget) {
         // Asset currently in-flight. Add the widget reference to in order for the callback to get dispatched later.
         m_resourcesMutex.lock();
@@ -268,24 +437,24 @@ bool CAsyncResourceManager::request(ResourceID id, const AWP<IWidget>& widget) {
     return true;
 }
 
-void CAsyncResourceManager::enqueue(ResourceID resourceID, const ASP<IAsyncResource>& resource, const AWP<IWidget>& widget) {
-    m_gatherer.enqueue(resource);
-
+void CAsyncResourceManager::enqueue(ResourceID resourceID, const ASP<IAsyncResource>& resource, const AWP<IWidget>& widget, eResourcePriority priority) {
     m_resourcesMutex.lock();
     if (m_resources.contains(resourceID))
         Debug::log(ERR, "Resource already enqueued! This is a bug.");
 
-    m_resources[resourceID] = {resource, {widget}};
+    const auto PACKED = makeAtomicShared<CPackedResource>(resource);
+
+    m_resources[resourceID] = {PACKED, {widget}};
     m_resourcesMutex.unlock();
 
-    resource->m_events.finished.listenStatic([resourceID]() {
-        g_pHyprlock->addTimer(std::chrono::milliseconds(0), [](auto, void* resourceID) { g_asyncResourceManager->onResourceFinished((size_t)resourceID); }, (void*)resourceID);
-    });
+    m_jobQueue.enqueue(resourceID, priority, CAtomicSharedPointer<IAsyncResource>{PACKED},
+                       [resourceID, PACKED]() { g_asyncResourceManager->onResourceFinished(resourceID, PACKED); });
 }
 
-void CAsyncResourceManager::onResourceFinished(ResourceID id) {
+void CAsyncResourceManager::onResourceFinished(ResourceID id, const ASP<CPackedResource>& resource) {
     m_resourcesMutex.lock();
-    if (!m_resources.contains(id)) {
+    // A different resource means this one got released and requested again while rendering.
+    if (!m_resources.contains(id) || m_resources[id].first.get() != resource.get()) {
         m_resourcesMutex.unlock();
         return;
     }
@@ -295,57 +464,93 @@ void CAsyncResourceManager::onResourceFinished(ResourceID id) {
     m_resources.erase(id);
     m_resourcesMutex.unlock();
 
-    if (!m_assets.contains(id) || m_assets[id].refs == 0) // Not referenced? Drop it
-        return;
+    if (!m_assets.contains(id) || !RESOURCE || !RESOURCE->m_pixels) { // Not referenced, failed or unchanged? Drop it
+        resolveCritical(id);
+
+        // Let the widgets drop their pending handle. There is no new texture, so nothing to redraw either.
+        if (m_assets.contains(id)) {
+            for (const auto& widget : WIDGETS) {
+                if (widget)
+                    widget->onAssetUpdate(id, nullptr);
+            }
+        }
 
-    if (!RESOURCE || !RESOURCE->m_asset.cairoSurface)
         return;
+    }
 
     Debug::log(TRACE, "Resource to texture id:{}", id);
 
-    const auto           texture = makeAtomicShared<CTexture>();
-
-    const cairo_status_t SURFACESTATUS = (cairo_status_t)RESOURCE->m_asset.cairoSurface->status();
-    const auto           CAIROFORMAT   = cairo_image_surface_get_format(RESOURCE->m_asset.cairoSurface->cairo());
-    const GLint          glIFormat     = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB32F : GL_RGBA;
-    const GLint          glFormat      = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB : GL_RGBA;
-    const GLint          glType        = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_FLOAT : GL_UNSIGNED_BYTE;
+    const auto& PIXELS = *RESOURCE->m_pixels;
+    if (PIXELS.data.empty()) {
+        Debug::log(ERR, "resourceID: {} invalid", id);
+        const auto texture = makeAtomicShared<CTexture>();
+        texture->m_iType   = TEXTURE_INVALID;
+        texture->m_vSize   = RESOURCE->m_asset.pixelSize;
+        onResourceUploaded(id, texture, WIDGETS);
+        return;
+    }
 
-    if (SURFACESTATUS != CAIRO_STATUS_SUCCESS) {
-        Debug::log(ERR, "resourceID: {} invalid ({})", id, cairo_status_to_string(SURFACESTATUS));
-        texture->m_iType = TEXTURE_INVALID;
+    auto texture = m_texturePool.take(RESOURCE->m_asset.pixelSize, PIXELS.internalFormat);
+    if (!texture) {
+        texture          = makeAtomicShared<CTexture>();
+        texture->m_vSize = RESOURCE->m_asset.pixelSize;
     }
 
-    texture->m_vSize = RESOURCE->m_asset.pixelSize;
-    texture->allocate();
+    m_uploader.enqueue(CTextureUploader::SUpload{
+        .texture        = texture,
+        .data           = PIXELS.data.data(),
+        .stride         = (size_t)texture->m_vSize.x * PIXELS.bytesPerPixel,
+        .bytesPerPixel  = PIXELS.bytesPerPixel,
+        .internalFormat = PIXELS.internalFormat,
+        .format         = PIXELS.format,
+        .type           = PIXELS.type,
+        // The resource is captured to keep the pixels alive until the upload is done.
+        .onDone = [this, id, texture, WIDGETS, RESOURCE]() { onResourceUploaded(id, texture, WIDGETS); },
+    });
+}
+
+void CAsyncResourceManager::onResourceUploaded(ResourceID id, ASP<CTexture> texture, const std::vector<AWP<IWidget>>& widgets) {
+    resolveCritical(id);
 
-    glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    if (CAIROFORMAT != CAIRO_FORMAT_RGB96F) {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    if (!m_assets.contains(id)) { // Released while uploading
+        m_texturePool.put(std::move(texture));
+        return;
     }
-    glTexImage2D(GL_TEXTURE_2D, 0, glIFormat, texture->m_vSize.x, texture->m_vSize.y, 0, glFormat, glType, RESOURCE->m_asset.cairoSurface->data());
 
-    m_assets[id].texture = texture;
+    m_slots[m_assets[id]].texture = texture;
 
-    for (const auto& widget : WIDGETS) {
+    for (const auto& widget : widgets) {
         if (widget)
             widget->onAssetUpdate(id, texture);
     }
 
-    g_pHyprlock->renderAllOutputs();
+    scheduleRender();
+}
 
-    if (!m_gathered && !g_pHyprlock->m_bImmediateRender) {
-        m_resourcesMutex.lock();
-        if (m_resources.empty()) {
-            m_gathered = true;
-            if (m_gatheredEventfd.isValid())
-                eventfd_write(m_gatheredEventfd.get(), 1);
+void CAsyncResourceManager::scheduleRender() {
+    if (m_renderScheduled)
+        return;
+
+    m_renderScheduled = true;
+    g_pHyprlock->addTimer(std::chrono::milliseconds(0), [this](auto, auto) {
+        m_renderScheduled = false;
 
-            m_gatheredEventfd.reset();
+        // onAssetUpdate may request more assets.
+        for (const auto& hit : std::exchange(m_cacheHits, {})) {
+            if (const auto PWIDGET = hit.widget.lock())
+                PWIDGET->onAssetUpdate(hit.id, hit.texture);
         }
-        m_resourcesMutex.unlock();
-    }
+
+        g_pHyprlock->renderAllOutputs();
+    }, nullptr);
+}
+
+int CAsyncResourceManager::completionFd() const {
+    return m_jobQueue.completionFd();
+}
+
+void CAsyncResourceManager::processCompletions() {
+    const auto COUNT = m_jobQueue.runCompletions();
+    if (COUNT > 1)
+        Debug::log(TRACE, "[resource] {} resources finished in one batch", COUNT);
 }
@@ -3,89 +3,154 @@
 #include "../defines.hpp"
 #include "./Texture.hpp"
 #include "./Screencopy.hpp"
+#include "./TextureUploader.hpp"
+#include "./TexturePool.hpp"
+#include "./ShmBufferPool.hpp"
+#include "./DmaBufferPool.hpp"
+#include "./ResourceJobQueue.hpp"
+#include "./ResourceHandle.hpp"
 #include "./widgets/IWidget.hpp"
+#include "./resources/PackedResource.hpp"
+#include "./resources/TextCmdResource.hpp"
 
-#include <hyprgraphics/resource/AsyncResourceGatherer.hpp>
 #include <hyprgraphics/resource/resources/AsyncResource.hpp>
 #include <hyprgraphics/resource/resources/TextResource.hpp>
 #include <hyprgraphics/resource/resources/ImageResource.hpp>
 #include <hyprutils/os/FileDescriptor.hpp>
+#include <unordered_set>
 
 class CAsyncResourceManager {
 
   public:
     // Notes on resource lifetimes:
     // Resources id's are the result of hashing the requested resource parameters.
-    // When a new request is made, adding a new entry to the m_assets map is done immediatly.
-    // Subsequent calls through this section with the same resource id will increment the texture's references.
-    // The manager will release the resource when refs reaches 0, while the resource itelf may outlife it's reference in the manager.
-    // Why not use ASP/AWP for this?
-    // The problem is that we want to to increment the reference as soon as requesting the resource id.
-    // Not only when actually retrieving the asset with `getAssetById`.
-    //
-    // Improvement idea: Make a wrapper object that is returned when requesting and contains the resource id. Then we can unload with RAII.
-
-    // Those are hash functions that return the id for a requested resource.
-    static ResourceID resourceIDForTextRequest(const CTextResource::STextResourceData& s);
+    // When a new request is made, an asset slot is allocated immediately and the request returns a CResourceHandle to it.
+    // Subsequent requests with the same resource id hand out another handle to the same slot.
+    // The manager will release the slot when the last handle is gone, while the texture itself may outlive it through ASP references.
+    // Releasing an in-flight resource cancels its job if it didn't start yet.
+
+    // Those build the key for a requested resource. The resource id is the hash of it.
+    static CResourceKey resourceKeyForTextRequest(const CTextResource::STextResourceData& s);
     // Consumer needs to increment the revision parameter to get a new command evaluation.
-    static ResourceID resourceIDForTextCmdRequest(const CTextResource::STextResourceData& s, size_t revision);
+    static CResourceKey resourceKeyForTextCmdRequest(const CTextResource::STextResourceData& s, size_t revision);
     // Image paths may be file system links, thus this function supports a revision parameter that gets factored into the resource id.
-    static ResourceID resourceIDForImageRequest(const std::string& path, size_t revision);
-    static ResourceID resourceIDForScreencopy(const std::string& port);
+    // The target size is part of the id, because the same image gets decoded at different resolutions.
+    static CResourceKey resourceKeyForImageRequest(const std::string& path, size_t revision, const Vector2D& targetSize);
+    static CResourceKey resourceKeyForScreencopy(const std::string& port);
+    static ResourceID   resourceIDForScreencopy(const std::string& port);
 
     struct SPreloadedTexture {
+        ResourceID    id;
         ASP<CTexture> texture;
         size_t        refs = 0;
+        std::string   key; // the full CResourceKey, to tell hash collisions apart
     };
 
-    CAsyncResourceManager()  = default;
+    CAsyncResourceManager();
     ~CAsyncResourceManager() = default;
 
-    ResourceID requestText(const CTextResource::STextResourceData& params, const AWP<IWidget>& widget);
+    // Widgets that pass themselves get onAssetUpdate called once the asset is ready, always from the event loop.
+    CResourceHandle requestText(const CTextResource::STextResourceData& params, const AWP<IWidget>& widget, eResourcePriority priority);
     // Same as requestText but substitute the text with what launching sh -c request.text returns.
-    ResourceID    requestTextCmd(const CTextResource::STextResourceData& params, size_t revision, const AWP<IWidget>& widget);
-    ResourceID    requestImage(const std::string& path, size_t revision, const AWP<IWidget>& widget);
-
-    ASP<CTexture> getAssetByID(ResourceID id);
-
-    void          unload(ASP<CTexture> resource);
-    void          unloadById(ResourceID id);
+    // Always scheduled with RESOURCE_PRIORITY_DYNAMIC.
+    // With lastOutput set, output that didn't change since the last run is not rendered. The widget gets onAssetUpdate with nullptr then.
+    CResourceHandle requestTextCmd(const CTextResource::STextResourceData& params, size_t revision, const AWP<IWidget>& widget, const ASP<STextCmdOutput>& lastOutput = nullptr);
+    // The image gets downscaled on the worker, so that it just covers targetSize. Pass 0x0 to get the full resolution.
+    CResourceHandle requestImage(const std::string& path, size_t revision, const Vector2D& targetSize, const AWP<IWidget>& widget, eResourcePriority priority);
+    // Another reference to an asset that is already known, like a screencopy frame. Empty if there is none.
+    CResourceHandle acquire(ResourceID id);
+    // Drops the handle a widget got by requesting with itself as the callback target, if rendering didn't start yet.
+    // Returns false and keeps the handle if it is already rendering. The widget's callback will still be called in that case.
+    bool            cancelRequest(CResourceHandle& handle, const AWP<IWidget>& widget);
 
     void          enqueueStaticAssets();
     void          enqueueScreencopyFrames();
     void          screencopyToTexture(const CScreencopyFrame& scFrame);
+    // Destroys the frame. Don't touch it after calling this.
+    void          screencopyFailed(const CScreencopyFrame& scFrame);
+    // Dispatches wayland events and timers until every critical resource is resolved or general:gather_timeout passed.
     void          gatherInitialResources(wl_display* display);
-
-    bool          checkIdPresent(ResourceID id);
+    // Marks a critical resource as done, no matter if it succeeded. Locking only waits for those.
+    void          resolveCritical(ResourceID id);
+    // Readable while rendered resources wait for processCompletions().
+    int completionFd() const;
+    // Takes every resource that finished rendering since the last call and queues their uploads in one go.
+    void processCompletions();
+
+    // Textures for finished resources and shm screencopy frames are streamed through this.
+    CTextureUploader m_uploader;
+    // Back shm and dmabuf screencopy frames.
+    CShmBufferPool m_shmPool;
+    CDmaBufferPool m_dmaPool;
 
   private:
-    // Returns whether or not the id was already requested.
+    // For CResourceHandle
+    ASP<CTexture> textureForSlot(uint32_t slot);
+    void          release(uint32_t slot);
+    // Takes a reference on the slot.
+    CResourceHandle makeHandle(uint32_t slot);
+    // Creates the asset entry for id with no references.
+    uint32_t allocSlot(ResourceID id, const CResourceKey& key);
+
+    // Returns the id of the asset for key. Probes past ids that are taken by a different key.
+    ResourceID lookup(const CResourceKey& key);
+    // Returns whether or not the id was already requested. handle gets a reference in both cases.
     // Makes sure the widgets onAssetCallback function gets called.
-    bool request(ResourceID id, const AWP<IWidget>& widget);
-    // Adds a new resource to m_resources and passes it to m_gatherer.
-    void enqueue(ResourceID resourceID, const ASP<IAsyncResource>& resource, const AWP<IWidget>& widget);
+    bool request(ResourceID id, const CResourceKey& key, const AWP<IWidget>& widget, CResourceHandle& handle);
+    // Adds a new resource to m_resources and passes it to m_jobQueue.
+    // The resource gets wrapped in a CPackedResource, so the pixels are converted on the worker.
+    void enqueue(ResourceID resourceID, const ASP<IAsyncResource>& resource, const AWP<IWidget>& widget, eResourcePriority priority);
+    // Called when the last reference to an asset is gone. Cancels the job if it is still in-flight.
+    void onReleased(ResourceID id);
     // Callback for finished resources.
-    // Copies the resources cairo surface to a GL_TEXTURE_2D and sets it in the asset map.
-    // Removes the entry in m_resources.
+    // Removes the entry in m_resources and queues an upload of the packed pixels to a GL_TEXTURE_2D.
+    // Results of a request that got released in the meantime are dropped.
+    // Widgets of a resource that produced nothing get onAssetUpdate with nullptr right away.
+    void onResourceFinished(ResourceID id, const ASP<CPackedResource>& resource);
+    // Called once the upload is done. Sets the texture in the asset map.
     // Call onAssetUpdate for all stored widget references.
-    void onResourceFinished(ResourceID id);
-
-    // For polling when using gatherInitialResources.
+    void onResourceUploaded(ResourceID id, ASP<CTexture> texture, const std::vector<AWP<IWidget>>& widgets);
+    // Renders all outputs once in the next loop iteration, no matter how many uploads finish until then.
+    // Cache hits queued in m_cacheHits are dispatched right before that render.
+    void scheduleRender();
+    // Drops the frame. Once the last one is gone, the capture buffers are released.
+    void removeScreencopyFrame(const CScreencopyFrame& scFrame);
+
+    // Screencopy frames and backgrounds. Everything else streams in after the session got locked.
+    std::unordered_set<ResourceID> m_critical;
     bool                           m_gathered = false;
-    Hyprutils::OS::CFileDescriptor m_gatheredEventfd;
 
     bool                           m_exit = false;
 
+    bool                           m_renderScheduled = false;
+
+    // Requests for assets that were already loaded. Their widgets get onAssetUpdate with the next scheduled render.
+    struct SCacheHit {
+        ResourceID    id;
+        ASP<CTexture> texture;
+        AWP<IWidget>  widget;
+    };
+    std::vector<SCacheHit>         m_cacheHits;
+
     int                            m_loadedAssets = 0;
 
     // not shared between threads
-    std::unordered_map<ResourceID, SPreloadedTexture> m_assets;
-    std::vector<UP<CScreencopyFrame>>                 m_scFrames;
+    std::vector<SPreloadedTexture>           m_slots;
+    std::vector<uint32_t>                    m_freeSlots;
+    std::unordered_map<ResourceID, uint32_t> m_assets; // id -> index into m_slots
+    std::vector<UP<CScreencopyFrame>>        m_scFrames;
+    CTexturePool                             m_texturePool;
     // shared between threads
-    std::mutex                                                                                              m_resourcesMutex;
-    std::unordered_map<ResourceID, std::pair<ASP<Hyprgraphics::IAsyncResource>, std::vector<AWP<IWidget>>>> m_resources;
+    std::mutex                                                                                 m_resourcesMutex;
+    std::unordered_map<ResourceID, std::pair<ASP<CPackedResource>, std::vector<AWP<IWidget>>>> m_resources;
+
+    CResourceJobQueue                                                                          m_jobQueue;
+
+    // Preloaded static assets and screencopy frames stay around for the whole session.
+    // Declared last, so that they are released while everything else is still there.
+    std::vector<CResourceHandle> m_persistent;
 
-    Hyprgraphics::CAsyncResourceGatherer                                                                    m_gatherer;
+    friend class CResourceHandle;
 };
 
 inline UP<CAsyncResourceManager> g_asyncResourceManager;
@@ -0,0 +1,225 @@
+#include "DmaBufferPool.hpp"
+#include "../core/hyprlock.hpp"
+#include "../core/Egl.hpp"
+#include "../helpers/Log.hpp"
+#include "linux-dmabuf-v1.hpp"
+#include <EGL/eglext.h>
+#include <algorithm>
+#include <libdrm/drm_fourcc.h>
+#include <unistd.h>
+
+static PFNEGLQUERYDMABUFMODIFIERSEXTPROC eglQueryDmaBufModifiersEXT = nullptr;
+
+SDmaBuffer::~SDmaBuffer() {
+    wlBuffer.reset();
+
+    if (image != EGL_NO_IMAGE && g_pEGL)
+        eglDestroyImage(g_pEGL->eglDisplay, image);
+
+    for (int plane = 0; plane < planes; ++plane) {
+        if (fd[plane] >= 0)
+            close(fd[plane]);
+    }
+
+    if (bo)
+        gbm_bo_destroy(bo);
+}
+
+SP<SDmaBuffer> CDmaBufferPool::acquire(uint32_t w, uint32_t h, uint32_t fmt, const std::vector<uint64_t>& allowedMods) {
+    const auto IT = std::ranges::find_if(m_buffers, [&](const auto& b) {
+        return !b->busy && b->texture.expired() && b->w == w && b->h == h && b->fmt == fmt && (allowedMods.empty() || std::ranges::find(allowedMods, b->mod) != allowedMods.end());
+    });
+
+    if (IT != m_buffers.end()) {
+        Debug::log(TRACE, "[bo] Reusing buffer {}x{} fmt {:x}", w, h, fmt);
+        (*IT)->busy = true;
+        return *IT;
+    }
+
+    auto buffer = create(w, h, fmt, allowedMods);
+    if (!buffer)
+        return nullptr;
+
+    buffer->busy = true;
+    m_buffers.emplace_back(buffer);
+    return buffer;
+}
+
+void CDmaBufferPool::release(const SP<SDmaBuffer>& buffer) {
+    if (buffer)
+        buffer->busy = false;
+}
+
+void CDmaBufferPool::trim() {
+    const auto BEFORE = m_buffers.size();
+    std::erase_if(m_buffers, [](const auto& b) { return !b->busy && b->texture.expired(); });
+
+    if (BEFORE != m_buffers.size())
+        Debug::log(TRACE, "[bo] Freed {} idle buffer(s)", BEFORE - m_buffers.size());
+}
+
+const std::vector<uint64_t>& CDmaBufferPool::modifiersFor(uint32_t fmt) {
+    if (const auto IT = m_modifiers.find(fmt); IT != m_modifiers.end())
+        return IT->second;
+
+    auto& mods = m_modifiers[fmt];
+
+    if (!eglQueryDmaBufModifiersEXT)
+        eglQueryDmaBufModifiersEXT = (PFNEGLQUERYDMABUFMODIFIERSEXTPROC)eglGetProcAddress("eglQueryDmaBufModifiersEXT");
+
+    if (!eglQueryDmaBufModifiersEXT) {
+        Debug::log(WARN, "Querying modifiers without eglQueryDmaBufModifiersEXT support");
+        return mods;
+    }
+
+    std::array<uint64_t, 64>   eglMods;
+    std::array<EGLBoolean, 64> externalOnly;
+    int                        num = 0;
+    if (!eglQueryDmaBufModifiersEXT(g_pEGL->eglDisplay, fmt, 64, eglMods.data(), externalOnly.data(), &num) || num == 0) {
+        Debug::log(WARN, "eglQueryDmaBufModifiersEXT failed, falling back to regular bo");
+        return mods;
+    }
+
+    Debug::log(LOG, "eglQueryDmaBufModifiersEXT found {} mods for format {:x}", num, fmt);
+
+    // Prefer what the compositor advertised for this format, if it told us anything.
+    const auto& COMPOSITORMODS    = g_pHyprlock->dma.dmabufMods;
+    const bool  HASCOMPOSITORMODS = std::ranges::any_of(COMPOSITORMODS, [fmt](const auto& m) { return m.fourcc == fmt; });
+
+    for (int i = 0; i < num; ++i) {
+        if (externalOnly[i]) {
+            Debug::log(TRACE, "Modifier {:x} failed test", eglMods[i]);
+            continue;
+        }
+
+        if (HASCOMPOSITORMODS && !std::ranges::any_of(COMPOSITORMODS, [&](const auto& m) { return m.fourcc == fmt && m.mod == eglMods[i]; })) {
+            Debug::log(TRACE, "Modifier {:x} not supported by the compositor", eglMods[i]);
+            continue;
+        }
+
+        Debug::log(TRACE, "Modifier {:x} passed test", eglMods[i]);
+        mods.emplace_back(eglMods[i]);
+    }
+
+    return mods;
+}
+
+SP<SDmaBuffer> CDmaBufferPool::create(uint32_t w, uint32_t h, uint32_t fmt, const std::vector<uint64_t>& allowedMods) {
+    const uint32_t        FLAGS = GBM_BO_USE_RENDERING;
+    std::vector<uint64_t> mods  = modifiersFor(fmt);
+
+    if (!allowedMods.empty())
+        std::erase_if(mods, [&](uint64_t mod) { return std::ranges::find(allowedMods, mod) == allowedMods.end(); });
+
+    auto                  buffer = makeShared<SDmaBuffer>();
+    buffer->w                    = w;
+    buffer->h                    = h;
+    buffer->fmt                  = fmt;
+
+    if (!mods.empty())
+        buffer->bo = gbm_bo_create_with_modifiers2(g_pHyprlock->dma.gbmDevice, w, h, fmt, mods.data(), mods.size(), FLAGS);
+
+    // An implicit modifier only works if the compositor didn't restrict them, or explicitly allows it.
+    if (!buffer->bo && (allowedMods.empty() || std::ranges::find(allowedMods, DRM_FORMAT_MOD_INVALID) != allowedMods.end()))
+        buffer->bo = gbm_bo_create(g_pHyprlock->dma.gbmDevice, w, h, fmt, FLAGS);
+
+    if (!buffer->bo) {
+        Debug::log(ERR, "[bo] Couldn't create a drm buffer");
+        return nullptr;
+    }
+
+    buffer->planes = gbm_bo_get_plane_count(buffer->bo);
+    Debug::log(LOG, "[bo] has {} plane(s)", buffer->planes);
+
+    buffer->mod = gbm_bo_get_modifier(buffer->bo);
+    Debug::log(LOG, "[bo] chose modifier {:x}", buffer->mod);
+
+    auto params = makeShared<CCZwpLinuxBufferParamsV1>(g_pHyprlock->dma.linuxDmabuf->sendCreateParams());
+    if (!params) {
+        Debug::log(ERR, "zwp_linux_dmabuf_v1_create_params failed");
+        return nullptr;
+    }
+
+    for (int plane = 0; plane < buffer->planes; plane++) {
+        buffer->stride[plane] = gbm_bo_get_stride_for_plane(buffer->bo, plane);
+        buffer->offset[plane] = gbm_bo_get_offset(buffer->bo, plane);
+        buffer->fd[plane]     = gbm_bo_get_fd_for_plane(buffer->bo, plane);
+
+        if (buffer->fd[plane] < 0) {
+            Debug::log(ERR, "gbm_bo_get_fd_for_plane failed");
+            return nullptr;
+        }
+
+        params->sendAdd(buffer->fd[plane], plane, buffer->offset[plane], buffer->stride[plane], buffer->mod >> 32, buffer->mod & 0xffffffff);
+    }
+
+    buffer->wlBuffer = makeShared<CCWlBuffer>(params->sendCreateImmed(w, h, fmt, (zwpLinuxBufferParamsV1Flags)0));
+    params.reset();
+
+    if (!buffer->wlBuffer) {
+        Debug::log(ERR, "[pw] zwp_linux_buffer_params_v1_create_immed failed");
+        return nullptr;
+    }
+
+    return buffer;
+}
+
+bool CDmaBufferPool::ensureImage(const SP<SDmaBuffer>& buffer) {
+    if (buffer->image != EGL_NO_IMAGE)
+        return true;
+
+    static constexpr struct {
+        EGLAttrib fd;
+        EGLAttrib offset;
+        EGLAttrib pitch;
+        EGLAttrib modlo;
+        EGLAttrib modhi;
+    } attrNames[4] = {{.fd     = EGL_DMA_BUF_PLANE0_FD_EXT,
+                       .offset = EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+                       .pitch  = EGL_DMA_BUF_PLANE0_PITCH_EXT,
+                       .modlo  = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+                       .modhi  = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT},
+                      {.fd     = EGL_DMA_BUF_PLANE1_FD_EXT,
+                       .offset = EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+                       .pitch  = EGL_DMA_BUF_PLANE1_PITCH_EXT,
+                       .modlo  = EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+                       .modhi  = EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT},
+                      {.fd     = EGL_DMA_BUF_PLANE2_FD_EXT,
+                       .offset = EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+                       .pitch  = EGL_DMA_BUF_PLANE2_PITCH_EXT,
+                       .modlo  = EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
+                       .modhi  = EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT},
+                      {.fd     = EGL_DMA_BUF_PLANE3_FD_EXT,
+                       .offset = EGL_DMA_BUF_PLANE3_OFFSET_EXT,
+                       .pitch  = EGL_DMA_BUF_PLANE3_PITCH_EXT,
+                       .modlo  = EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT,
+                       .modhi  = EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT}};
+
+    std::vector<EGLAttrib> attribs = {
+        EGL_WIDTH, buffer->w, EGL_HEIGHT, buffer->h, EGL_LINUX_DRM_FOURCC_EXT, buffer->fmt,
+    };
+    for (int i = 0; i < buffer->planes; i++) {
+        attribs.emplace_back(attrNames[i].fd);
+        attribs.emplace_back(buffer->fd[i]);
+        attribs.emplace_back(attrNames[i].offset);
+        attribs.emplace_back(buffer->offset[i]);
+        attribs.emplace_back(attrNames[i].pitch);
+        attribs.emplace_back(buffer->stride[i]);
+        if (buffer->mod != DRM_FORMAT_MOD_INVALID) {
+            attribs.emplace_back(attrNames[i].modlo);
+            attribs.emplace_back(buffer->mod & 0xFFFFFFFF);
+            attribs.emplace_back(attrNames[i].modhi);
+            attribs.emplace_back(buffer->mod >> 32);
+        }
+    }
+    attribs.emplace_back(EGL_NONE);
+
+    buffer->image = eglCreateImage(g_pEGL->eglDisplay, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attribs.data());
+
+    if (buffer->image == EGL_NO_IMAGE) {
+        Debug::log(ERR, "Failed creating an egl image");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "Texture.hpp"
+#include "wayland.hpp"
+#include <EGL/egl.h>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <gbm.h>
+
+// A gbm_bo exported as a wl_buffer, together with its plane fds and the EGLImage importing it. Owned by CDmaBufferPool.
+struct SDmaBuffer {
+    ~SDmaBuffer();
+
+    gbm_bo*                 bo     = nullptr;
+    int                     planes = 0;
+    uint64_t                mod    = 0;
+
+    std::array<int, 4>      fd     = {-1, -1, -1, -1};
+    std::array<uint32_t, 4> stride = {}, offset = {};
+
+    uint32_t                w = 0, h = 0, fmt = 0;
+
+    SP<CCWlBuffer>          wlBuffer = nullptr;
+    // Created on first use and kept for later captures.
+    EGLImage                image = EGL_NO_IMAGE;
+
+    bool                    busy = false;
+    // A texture sampling from the image. The bo must not be written to again while it's alive.
+    AWP<CTexture>           texture;
+};
+
+// Hands out dmabuf screencopy buffers.
+// The modifiers that can be used for a format are negotiated once and cached.
+// Buffers get reused for later captures with the same size and format once released and no texture references them anymore.
+class CDmaBufferPool {
+  public:
+    // Returns nullptr on failure. A non-empty allowedMods restricts the modifiers the buffer may use.
+    SP<SDmaBuffer> acquire(uint32_t w, uint32_t h, uint32_t fmt, const std::vector<uint64_t>& allowedMods = {});
+    void           release(const SP<SDmaBuffer>& buffer);
+    // Creates buffer->image if it doesn't exist yet. Returns false on failure.
+    bool           ensureImage(const SP<SDmaBuffer>& buffer);
+    // Frees all buffers that are neither in use nor backing a texture.
+    void           trim();
+
+  private:
+    SP<SDmaBuffer>                                      create(uint32_t w, uint32_t h, uint32_t fmt, const std::vector<uint64_t>& allowedMods);
+    const std::vector<uint64_t>&                        modifiersFor(uint32_t fmt);
+
+    std::unordered_map<uint32_t, std::vector<uint64_t>> m_modifiers;
+    std::vector<SP<SDmaBuffer>>                         m_buffers;
+};
@@ -25,8 +25,9 @@ bool CFramebuffer::alloc(int w, int h, bool highres) {
     uint32_t glFormat = highres ? GL_RGBA16F : drmFormatToGL(DRM_FORMAT_XRGB2101010); // TODO: revise only 10b when I find a way to figure out without sc whether display is 10b
     uint32_t glType   = highres ? GL_FLOAT : glFormatToType(glFormat);
 
-    if (m_iFb == (uint32_t)-1) {
-        firstAlloc = true;
+    if (m_iFb == (uint32_t)-1 || m_bTextureOnly) {
+        firstAlloc     = true;
+        m_bTextureOnly = false;
         glGenFramebuffers(1, &m_iFb);
     }
 
@@ -95,6 +96,8 @@ void CFramebuffer::addStencil() {
 }
 
 void CFramebuffer::bind() const {
+    RASSERT(!m_bTextureOnly, "Binding a framebuffer without a framebuffer object. It was baked on another context!");
+
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_iFb);
     glViewport(0, 0, m_vSize.x, m_vSize.y);
 }
@@ -113,12 +116,22 @@ void CFramebuffer::destroyBuffer() {
     m_iFb           = -1;
     m_vSize         = Vector2D();
     m_pStencilTex   = nullptr;
+    m_bTextureOnly  = false;
 }
 
 CFramebuffer::~CFramebuffer() {
     destroyBuffer();
 }
 
+void CFramebuffer::releaseFramebufferObject() {
+    if (m_iFb != (uint32_t)-1 && m_iFb)
+        glDeleteFramebuffers(1, &m_iFb);
+
+    // Still counts as allocated, the texture is what gets drawn.
+    m_iFb          = 0;
+    m_bTextureOnly = true;
+}
+
 bool CFramebuffer::isAllocated() const {
     return m_iFb != (GLuint)-1;
 }
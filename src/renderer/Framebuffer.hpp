@@ -13,6 +13,10 @@ class CFramebuffer {
     void          bind() const;
     void          destroyBuffer();
     bool          isAllocated() const;
+    // Deletes the framebuffer object, but keeps the texture. Framebuffer objects are not shared between contexts,
+    // so the gpu worker calls this before handing a baked framebuffer to the main thread.
+    // It can't be bound afterwards, until alloc creates a new framebuffer object.
+    void          releaseFramebufferObject();
 
     Vector2D      m_vSize;
 
@@ -23,4 +27,7 @@ class CFramebuffer {
 
     CFramebuffer& operator=(CFramebuffer&&)      = delete;
     CFramebuffer& operator=(const CFramebuffer&) = delete;
+
+  private:
+    bool m_bTextureOnly = false;
 };
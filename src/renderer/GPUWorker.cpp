@@ -0,0 +1,122 @@
+#include "GPUWorker.hpp"
+#include "Renderer.hpp"
+#include "../core/Egl.hpp"
+#include "../core/hyprlock.hpp"
+#include "../helpers/Log.hpp"
+#include <GLES3/gl32.h>
+#include <string>
+
+CGPUWorker::CGPUWorker() {
+    const char* exts = eglQueryString(g_pEGL->eglDisplay, EGL_EXTENSIONS);
+    if (!exts || !std::string{exts}.contains("EGL_KHR_fence_sync")) {
+        Debug::log(WARN, "[gpu] EGL_KHR_fence_sync not supported, baking on the main thread");
+        return;
+    }
+
+    // The worker has no surface to draw to, it only renders into framebuffers.
+    if (!std::string{exts}.contains("EGL_KHR_surfaceless_context")) {
+        Debug::log(WARN, "[gpu] EGL_KHR_surfaceless_context not supported, baking on the main thread");
+        return;
+    }
+
+    eglCreateSyncKHR     = (PFNEGLCREATESYNCKHRPROC)eglGetProcAddress("eglCreateSyncKHR");
+    eglDestroySyncKHR    = (PFNEGLDESTROYSYNCKHRPROC)eglGetProcAddress("eglDestroySyncKHR");
+    eglClientWaitSyncKHR = (PFNEGLCLIENTWAITSYNCKHRPROC)eglGetProcAddress("eglClientWaitSyncKHR");
+    if (!eglCreateSyncKHR || !eglDestroySyncKHR || !eglClientWaitSyncKHR) {
+        Debug::log(WARN, "[gpu] Failed to load the EGL_KHR_fence_sync functions, baking on the main thread");
+        return;
+    }
+
+    m_context = g_pEGL->createSharedContext();
+    if (m_context == EGL_NO_CONTEXT)
+        return;
+
+    // Only report ok once the worker actually got its context, otherwise bakes would be queued for a thread that is gone.
+    std::promise<bool> ready;
+    auto               readyFuture = ready.get_future();
+    m_thread                       = std::thread([this, ready = std::move(ready)]() mutable { threadLoop(ready); });
+
+    m_ok = readyFuture.get();
+    if (!m_ok) {
+        Debug::log(WARN, "[gpu] Worker thread failed to start, baking on the main thread");
+        m_thread.join();
+    }
+}
+
+CGPUWorker::~CGPUWorker() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_exit = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    if (m_context != EGL_NO_CONTEXT)
+        eglDestroyContext(g_pEGL->eglDisplay, m_context);
+}
+
+bool CGPUWorker::ok() const {
+    return m_ok;
+}
+
+void CGPUWorker::enqueue(std::function<void(CRenderer& renderer)>&& work, std::function<void()>&& done) {
+    RASSERT(m_ok, "CGPUWorker::enqueue without a working gpu worker");
+
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_jobs.emplace_back(SJob{.work = std::move(work), .done = std::move(done)});
+    }
+    m_cv.notify_one();
+}
+
+void CGPUWorker::threadLoop(std::promise<bool>& ready) {
+    if (!eglMakeCurrent(g_pEGL->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context)) {
+        Debug::log(ERR, "[gpu] Failed to make the worker context current (egl error {:x})", eglGetError());
+        ready.set_value(false);
+        eglReleaseThread();
+        return;
+    }
+
+    // Own shaders, see CRenderer::SWorkerContext.
+    auto renderer = makeUnique<CRenderer>(CRenderer::SWorkerContext{});
+
+    ready.set_value(true);
+
+    while (true) {
+        SJob job;
+        {
+            std::unique_lock lk(m_mutex);
+            m_cv.wait(lk, [this] { return m_exit || !m_jobs.empty(); });
+
+            if (m_exit)
+                break;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job.work(*renderer);
+
+        // The flush makes sure the fence actually gets submitted.
+        const auto SYNC = eglCreateSyncKHR(g_pEGL->eglDisplay, EGL_SYNC_FENCE_KHR, nullptr);
+        if (SYNC == EGL_NO_SYNC_KHR) {
+            Debug::log(ERR, "[gpu] eglCreateSyncKHR failed, falling back to glFinish");
+            glFinish();
+        } else {
+            if (eglClientWaitSyncKHR(g_pEGL->eglDisplay, SYNC, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR) != EGL_CONDITION_SATISFIED_KHR)
+                Debug::log(ERR, "[gpu] eglClientWaitSyncKHR failed");
+            eglDestroySyncKHR(g_pEGL->eglDisplay, SYNC);
+        }
+
+        job.work = nullptr;
+
+        if (job.done)
+            g_pHyprlock->addTimer(std::chrono::milliseconds(0), [done = std::move(job.done)](auto, auto) { done(); }, nullptr);
+    }
+
+    renderer.reset();
+    eglMakeCurrent(g_pEGL->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglReleaseThread();
+}
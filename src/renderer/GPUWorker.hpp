@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../defines.hpp"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+class CRenderer;
+
+// Runs one-off GPU work, like background bakes, on its own thread.
+// The thread has an EGL context that shares textures with the main context and its own set of shaders.
+// After a job the worker waits on an EGL fence, so the results are complete before `done` runs on the main thread.
+class CGPUWorker {
+  public:
+    CGPUWorker();
+    ~CGPUWorker();
+
+    // False if the shared context, EGL_KHR_fence_sync or EGL_KHR_surfaceless_context is unavailable,
+    // or the worker could not make its context current. Callers should do the work inline then.
+    bool ok() const;
+
+    // work runs on the worker thread, done in the main event loop.
+    void enqueue(std::function<void(CRenderer& renderer)>&& work, std::function<void()>&& done);
+
+  private:
+    struct SJob {
+        std::function<void(CRenderer& renderer)> work;
+        std::function<void()>                    done;
+    };
+
+    // Sets ready once the context is current, or failed to be.
+    void                        threadLoop(std::promise<bool>& ready);
+
+    EGLContext                  m_context = EGL_NO_CONTEXT;
+    bool                        m_ok      = false;
+
+    PFNEGLCREATESYNCKHRPROC     eglCreateSyncKHR     = nullptr;
+    PFNEGLDESTROYSYNCKHRPROC    eglDestroySyncKHR    = nullptr;
+    PFNEGLCLIENTWAITSYNCKHRPROC eglClientWaitSyncKHR = nullptr;
+
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cv;
+    std::deque<SJob>            m_jobs;
+    bool                        m_exit = false;
+
+    std::thread                 m_thread;
+};
+
+inline UP<CGPUWorker> g_pGPUWorker;
@@ -80,6 +80,19 @@ CRenderer::CRenderer() {
     glEnable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(glMessageCallbackA, nullptr);
 
+    createShaders();
+
+    g_pAnimationManager->createAnimation(0.f, opacity, g_pConfigManager->m_AnimationTree.getConfig("fadeIn"));
+}
+
+CRenderer::CRenderer(SWorkerContext) {
+    glEnable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(glMessageCallbackA, nullptr);
+
+    createShaders();
+}
+
+void CRenderer::createShaders() {
     GLuint prog          = createProgram(QUADVERTSRC, QUADFRAGSRC);
     rectShader.program   = prog;
     rectShader.proj      = glGetUniformLocation(prog, "proj");
@@ -193,8 +206,10 @@ CRenderer::CRenderer() {
     borderShader.angle2                = glGetUniformLocation(prog, "angle2");
     borderShader.gradientLerp          = glGetUniformLocation(prog, "gradientLerp");
     borderShader.alpha                 = glGetUniformLocation(prog, "alpha");
+}
 
-    g_pAnimationManager->createAnimation(0.f, opacity, g_pConfigManager->m_AnimationTree.getConfig("fadeIn"));
+void CRenderer::setOffscreenProjection(const Vector2D& size) {
+    projection = Mat3x3::outputProjection(size, HYPRUTILS_TRANSFORM_NORMAL);
 }
 
 //
@@ -264,11 +279,25 @@ void CRenderer::renderBorder(const CBox& box, const CGradientValueData& gradient
 
     glUniformMatrix3fv(borderShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
 
-    glUniform4fv(borderShader.gradient, gradient.m_vColorsOkLabA.size() / 4, (float*)gradient.m_vColorsOkLabA.data());
-    glUniform1i(borderShader.gradientLength, gradient.m_vColorsOkLabA.size() / 4);
-    glUniform1f(borderShader.angle, (int)(gradient.m_fAngle / (M_PI / 180.0)) % 360 * (M_PI / 180.0));
+    static const auto WRAPANGLE = [](float angle) -> float { return (int)(angle / (M_PI / 180.0)) % 360 * (M_PI / 180.0); };
+
+    // Animated gradients are blended in the shader. gradient is where the animation started, gradient2 the goal.
+    if (gradient.isLerping()) {
+        glUniform4fv(borderShader.gradient, gradient.m_vLerpFromOkLabA.size() / 4, (float*)gradient.m_vLerpFromOkLabA.data());
+        glUniform1i(borderShader.gradientLength, gradient.m_vLerpFromOkLabA.size() / 4);
+        glUniform1f(borderShader.angle, WRAPANGLE(gradient.m_fLerpFromAngle));
+        glUniform4fv(borderShader.gradient2, gradient.m_vColorsOkLabA.size() / 4, (float*)gradient.m_vColorsOkLabA.data());
+        glUniform1i(borderShader.gradient2Length, gradient.m_vColorsOkLabA.size() / 4);
+        glUniform1f(borderShader.angle2, WRAPANGLE(gradient.m_fAngle));
+        glUniform1f(borderShader.gradientLerp, gradient.m_fLerp);
+    } else {
+        glUniform4fv(borderShader.gradient, gradient.m_vColorsOkLabA.size() / 4, (float*)gradient.m_vColorsOkLabA.data());
+        glUniform1i(borderShader.gradientLength, gradient.m_vColorsOkLabA.size() / 4);
+        glUniform1f(borderShader.angle, WRAPANGLE(gradient.m_fAngle));
+        glUniform1i(borderShader.gradient2Length, 0);
+    }
+
     glUniform1f(borderShader.alpha, alpha);
-    glUniform1i(borderShader.gradient2Length, 0);
 
     const auto TOPLEFT  = Vector2D(ROUNDEDBOX.x, ROUNDEDBOX.y);
     const auto FULLSIZE = Vector2D(ROUNDEDBOX.width, ROUNDEDBOX.height);
@@ -398,7 +427,7 @@ std::vector<ASP<IWidget>>& CRenderer::getOrCreateWidgetsFor(const CSessionLockSu
 
         const auto POUTPUT = surf.m_outputRef.lock();
         for (auto& c : CWIDGETS) {
-            if (!c.monitor.empty() && c.monitor != POUTPUT->stringPort && !POUTPUT->stringDesc.starts_with(c.monitor) && !("desc:" + POUTPUT->stringDesc).starts_with(c.monitor))
+            if (!POUTPUT->matchesMonitor(c.monitor))
                 continue;
 
             // by type
@@ -598,6 +627,18 @@ void CRenderer::reconfigureWidgetsFor(OUTPUTID id) {
     removeWidgetsFor(id);
 }
 
+void CRenderer::setWidgetsSuspended(OUTPUTID id, bool suspended) {
+    if (!widgets.contains(id))
+        return;
+
+    for (const auto& widget : widgets[id]) {
+        if (suspended)
+            widget->onSuspend();
+        else
+            widget->onResume();
+    }
+}
+
 void CRenderer::startFadeIn() {
     Debug::log(LOG, "Starting fade in");
     *opacity = 1.f;
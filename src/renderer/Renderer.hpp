@@ -17,6 +17,11 @@ class CRenderer {
   public:
     CRenderer();
 
+    // Only compiles the shaders for the current context. Used by the gpu worker.
+    // Uniform values are program state, so the worker can't use the programs of the main context.
+    struct SWorkerContext {};
+    CRenderer(SWorkerContext);
+
     struct SRenderFeedback {
         bool needsFrame = false;
     };
@@ -35,6 +40,8 @@ class CRenderer {
     void            renderTexture(const CBox& box, const CTexture& tex, float a = 1.0, int rounding = 0, std::optional<eTransform> tr = {});
     void renderTextureMix(const CBox& box, const CTexture& tex, const CTexture& tex2, float a = 1.0, float mixFactor = 0.0, int rounding = 0, std::optional<eTransform> tr = {});
     void blurFB(const CFramebuffer& outfb, SBlurParams params);
+    // For rendering into framebuffers outside of renderLock.
+    void setOffscreenProjection(const Vector2D& size);
 
     std::chrono::system_clock::time_point firstFullFrameTime;
 
@@ -43,6 +50,8 @@ class CRenderer {
 
     void                                  removeWidgetsFor(OUTPUTID id);
     void                                  reconfigureWidgetsFor(OUTPUTID id);
+    // Calls onSuspend or onResume on the widgets of the output.
+    void setWidgetsSuspended(OUTPUTID id, bool suspended);
 
     void                                  startFadeIn();
     void                                  startFadeOut(bool unlock = false);
@@ -50,6 +59,8 @@ class CRenderer {
     std::vector<ASP<IWidget>>&            getOrCreateWidgetsFor(const CSessionLockSurface& surf);
 
   private:
+    void               createShaders();
+
     widgetMap_t        widgets;
 
     CShader            rectShader;
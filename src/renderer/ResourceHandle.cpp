@@ -0,0 +1,52 @@
+#include "ResourceHandle.hpp"
+#include "AsyncResourceManager.hpp"
+
+CResourceHandle::CResourceHandle(ResourceID id, uint32_t slot) : m_id(id), m_slot(slot) {
+    ;
+}
+
+CResourceHandle::~CResourceHandle() {
+    reset();
+}
+
+CResourceHandle::CResourceHandle(CResourceHandle&& other) noexcept : m_id(other.m_id), m_slot(other.m_slot) {
+    other.m_id   = {};
+    other.m_slot = INVALID_SLOT;
+}
+
+CResourceHandle& CResourceHandle::operator=(CResourceHandle&& other) noexcept {
+    if (this == &other)
+        return *this;
+
+    reset();
+
+    m_id         = other.m_id;
+    m_slot       = other.m_slot;
+    other.m_id   = {};
+    other.m_slot = INVALID_SLOT;
+    return *this;
+}
+
+ASP<CTexture> CResourceHandle::texture() const {
+    if (m_slot == INVALID_SLOT || !g_asyncResourceManager)
+        return nullptr;
+
+    return g_asyncResourceManager->textureForSlot(m_slot);
+}
+
+ResourceID CResourceHandle::id() const {
+    return m_id;
+}
+
+void CResourceHandle::reset() {
+    // The manager is gone on exit before the widgets are.
+    if (m_slot != INVALID_SLOT && g_asyncResourceManager)
+        g_asyncResourceManager->release(m_slot);
+
+    m_id   = {};
+    m_slot = INVALID_SLOT;
+}
+
+CResourceHandle::operator bool() const {
+    return m_slot != INVALID_SLOT;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "./Texture.hpp"
+#include <cstdint>
+
+// Holds one reference on an asset of the resource manager and drops it when destroyed.
+// Requesting a resource hands out a handle. The asset stays loaded as long as any handle to it exists.
+class CResourceHandle {
+  public:
+    CResourceHandle() = default;
+    ~CResourceHandle();
+
+    CResourceHandle(CResourceHandle&& other) noexcept;
+    CResourceHandle& operator=(CResourceHandle&& other) noexcept;
+
+    CResourceHandle(const CResourceHandle&)            = delete;
+    CResourceHandle& operator=(const CResourceHandle&) = delete;
+
+    // nullptr until the resource is ready.
+    ASP<CTexture> texture() const;
+    ResourceID    id() const;
+
+    // Drops the reference.
+    void reset();
+    // True while holding a reference.
+    explicit operator bool() const;
+
+  private:
+    CResourceHandle(ResourceID id, uint32_t slot);
+
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+    ResourceID                m_id;
+    uint32_t                  m_slot = INVALID_SLOT;
+
+    friend class CAsyncResourceManager;
+};
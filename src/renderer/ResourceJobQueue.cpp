@@ -0,0 +1,136 @@
+#include "ResourceJobQueue.hpp"
+#include "../helpers/Log.hpp"
+#include <algorithm>
+#include <sys/eventfd.h>
+
+CResourceJobQueue::CResourceJobQueue(size_t workers) {
+    workers      = std::max<size_t>(workers, 1);
+    m_maxDynamic = workers > 1 ? workers - 1 : 1;
+
+    m_completionFd = Hyprutils::OS::CFileDescriptor{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+    RASSERT(m_completionFd.isValid(), "[resource] Failed to create the completion eventfd");
+
+    Debug::log(LOG, "[resource] Starting {} resource workers", workers);
+
+    for (size_t i = 0; i < workers; i++) {
+        m_threads.emplace_back([this, i]() { threadLoop(i); });
+    }
+}
+
+CResourceJobQueue::~CResourceJobQueue() {
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_exit = true;
+    }
+    m_cv.notify_all();
+
+    for (auto& t : m_threads) {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+void CResourceJobQueue::enqueue(ResourceID id, eResourcePriority priority, const ASP<Hyprgraphics::IAsyncResource>& resource, std::function<void()>&& done) {
+    RASSERT(priority < RESOURCE_PRIORITY_COUNT, "CResourceJobQueue::enqueue with a bogus priority");
+
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_jobs[priority].emplace_back(SJob{.id = id, .resource = resource, .done = std::move(done), .enqueued = std::chrono::steady_clock::now()});
+    }
+    m_cv.notify_one();
+}
+
+bool CResourceJobQueue::cancel(ResourceID id) {
+    std::lock_guard<std::mutex> lg(m_mutex);
+    for (auto& queue : m_jobs) {
+        const auto IT = std::ranges::find_if(queue, [id](const auto& job) { return job.id == id; });
+        if (IT == queue.end())
+            continue;
+
+        queue.erase(IT);
+        Debug::log(TRACE, "[resource] Cancelled resourceID: {} before it started", id);
+        return true;
+    }
+
+    return false;
+}
+
+bool CResourceJobQueue::queued(ResourceID id) {
+    std::lock_guard<std::mutex> lg(m_mutex);
+    return std::ranges::any_of(m_jobs, [id](const auto& queue) { return std::ranges::any_of(queue, [id](const auto& job) { return job.id == id; }); });
+}
+
+// Called with m_mutex held.
+std::optional<size_t> CResourceJobQueue::nextQueue() const {
+    for (size_t i = 0; i < m_jobs.size(); i++) {
+        if (m_jobs[i].empty())
+            continue;
+
+        if (i == RESOURCE_PRIORITY_DYNAMIC && m_runningDynamic >= m_maxDynamic)
+            continue;
+
+        return i;
+    }
+
+    return std::nullopt;
+}
+
+void CResourceJobQueue::threadLoop(size_t worker) {
+    while (true) {
+        SJob job;
+        bool dynamic = false;
+        {
+            std::unique_lock lk(m_mutex);
+            m_cv.wait(lk, [this] { return m_exit || nextQueue().has_value(); });
+
+            if (m_exit)
+                break;
+
+            const auto QUEUE = *nextQueue();
+            job              = std::move(m_jobs[QUEUE].front());
+            m_jobs[QUEUE].pop_front();
+
+            dynamic = QUEUE == RESOURCE_PRIORITY_DYNAMIC;
+            if (dynamic)
+                m_runningDynamic++;
+        }
+
+        const auto STARTTP = std::chrono::steady_clock::now();
+
+        job.resource->render();
+        job.resource.reset();
+
+        const auto ENDTP = std::chrono::steady_clock::now();
+        Debug::log(TRACE, "[resource] resourceID: {} rendered on worker {} in {:.2f}ms after waiting {:.2f}ms", job.id, worker,
+                   std::chrono::duration<float, std::milli>(ENDTP - STARTTP).count(), std::chrono::duration<float, std::milli>(STARTTP - job.enqueued).count());
+
+        if (dynamic) {
+            {
+                std::lock_guard<std::mutex> lg(m_mutex);
+                m_runningDynamic--;
+            }
+            // A dynamic job might have been waiting for this slot.
+            m_cv.notify_one();
+        }
+
+        if (job.done && m_completions.push(std::move(job.done)))
+            eventfd_write(m_completionFd.get(), 1);
+    }
+}
+
+int CResourceJobQueue::completionFd() const {
+    return m_completionFd.get();
+}
+
+size_t CResourceJobQueue::runCompletions() {
+    // Clear the eventfd first. Anything pushed after that either gets drained below or signals again.
+    eventfd_t value = 0;
+    eventfd_read(m_completionFd.get(), &value);
+
+    auto completions = m_completions.drain();
+    for (auto& done : completions) {
+        done();
+    }
+
+    return completions.size();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "../helpers/MPSCQueue.hpp"
+#include <hyprgraphics/resource/resources/AsyncResource.hpp>
+#include <hyprutils/os/FileDescriptor.hpp>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Lower values get rendered first.
+enum eResourcePriority : uint8_t {
+    RESOURCE_PRIORITY_BACKGROUND = 0,
+    RESOURCE_PRIORITY_INPUT_FIELD,
+    RESOURCE_PRIORITY_STATIC,  // static labels and images
+    RESOURCE_PRIORITY_DYNAMIC, // cmd labels
+    RESOURCE_PRIORITY_COUNT,
+};
+
+// Renders async resources on a pool of worker threads, one FIFO per priority class.
+// Jobs that didn't start yet can be cancelled. A running job always renders to completion.
+// With more than one worker, one is kept free of dynamic jobs, so slow commands can't hold up images.
+class CResourceJobQueue {
+  public:
+    explicit CResourceJobQueue(size_t workers);
+    ~CResourceJobQueue();
+
+    // done runs from runCompletions() after resource->render().
+    void enqueue(ResourceID id, eResourcePriority priority, const ASP<Hyprgraphics::IAsyncResource>& resource, std::function<void()>&& done);
+    // Returns true if the job was still queued and got dropped.
+    bool cancel(ResourceID id);
+    // Whether the job is waiting for a worker, as opposed to rendering or done.
+    bool queued(ResourceID id);
+
+    // Readable while finished jobs wait for runCompletions().
+    int completionFd() const;
+    // Calls done for every job that finished since the last call, in the order they finished. Main thread only.
+    // Returns the number of completions.
+    size_t runCompletions();
+
+  private:
+    struct SJob {
+        ResourceID                            id;
+        ASP<Hyprgraphics::IAsyncResource>     resource;
+        std::function<void()>                 done;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    void                                                  threadLoop(size_t worker);
+    std::optional<size_t>                                 nextQueue() const;
+
+    std::mutex                                            m_mutex;
+    std::condition_variable                               m_cv;
+    std::array<std::deque<SJob>, RESOURCE_PRIORITY_COUNT> m_jobs;
+    size_t                                                m_runningDynamic = 0;
+    size_t                                                m_maxDynamic     = 1;
+    bool                                                  m_exit           = false;
+
+    // Finished jobs. Workers only signal the eventfd if the queue was empty.
+    CMPSCQueue<std::function<void()>> m_completions;
+    Hyprutils::OS::CFileDescriptor    m_completionFd;
+
+    std::vector<std::thread>          m_threads;
+};
@@ -1,49 +1,97 @@
 #include "Screencopy.hpp"
 #include "./AsyncResourceManager.hpp"
+#include "./TextureUploader.hpp"
+#include "./Framebuffer.hpp"
+#include "./Renderer.hpp"
 #include "../helpers/Log.hpp"
 #include "../helpers/MiscFunctions.hpp"
 #include "../core/hyprlock.hpp"
 #include "../core/Egl.hpp"
 #include "../config/ConfigManager.hpp"
 #include "wlr-screencopy-unstable-v1.hpp"
+#include "ext-image-capture-source-v1.hpp"
+#include "ext-image-copy-capture-v1.hpp"
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
-#include <cstring>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstring>
 #include <cstdint>
 #include <gbm.h>
 #include <hyprutils/memory/UniquePtr.hpp>
 #include <unistd.h>
-#include <sys/mman.h>
-#include <libdrm/drm_fourcc.h>
 #include <GLES3/gl32.h>
 #include <GLES3/gl3ext.h>
 #include <GLES2/gl2ext.h>
+#include <libdrm/drm_fourcc.h>
 
 static PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES = nullptr;
-static PFNEGLQUERYDMABUFMODIFIERSEXTPROC   eglQueryDmaBufModifiersEXT   = nullptr;
+
+// Cheapest first. 8 bit formats are the smallest to copy and the opaque ones let the compositor skip alpha.
+constexpr std::array<uint32_t, 8> DRM_FORMAT_PREFERENCE = {
+    DRM_FORMAT_XRGB8888,    DRM_FORMAT_ARGB8888,    DRM_FORMAT_XBGR8888,    DRM_FORMAT_ABGR8888,
+    DRM_FORMAT_XRGB2101010, DRM_FORMAT_ARGB2101010, DRM_FORMAT_XBGR2101010, DRM_FORMAT_ABGR2101010,
+};
+constexpr std::array<uint32_t, 10> SHM_FORMAT_PREFERENCE = {
+    WL_SHM_FORMAT_XRGB8888,    WL_SHM_FORMAT_ARGB8888,    WL_SHM_FORMAT_XBGR8888,    WL_SHM_FORMAT_ABGR8888, WL_SHM_FORMAT_XRGB2101010,
+    WL_SHM_FORMAT_ARGB2101010, WL_SHM_FORMAT_XBGR2101010, WL_SHM_FORMAT_ABGR2101010, WL_SHM_FORMAT_BGR888,   WL_SHM_FORMAT_RGB888,
+};
+
+template <typename T, size_t N>
+static const T* pickPreferred(const std::vector<T>& offered, const std::array<uint32_t, N>& preference) {
+    for (const auto FMT : preference) {
+        const auto IT = std::ranges::find_if(offered, [FMT](const auto& o) { return o.fmt == FMT; });
+        if (IT != offered.end())
+            return &*IT;
+    }
+
+    return nullptr;
+}
 
 //
-void CScreencopyFrame::capture(SP<COutput> pOutput) {
+void CScreencopyFrame::capture(SP<COutput> pOutput, float scale) {
     RASSERT(pOutput, "Screencopy, but no valid output");
 
-    static const auto SCMODE = g_pConfigManager->getValue<Hyprlang::INT>("general:screencopy_mode");
-
+    m_scale      = scale;
     m_asset      = makeAtomicShared<CTexture>();
     m_resourceID = CAsyncResourceManager::resourceIDForScreencopy(pOutput->stringPort);
 
+    if (g_pHyprlock->getImageCopyCapture() && g_pHyprlock->getOutputCaptureSource())
+        captureExt(pOutput);
+    else if (g_pHyprlock->getScreencopy())
+        captureWlr(pOutput);
+    else
+        Debug::log(ERR, "[sc] No screencopy protocol available");
+}
+
+void CScreencopyFrame::captureWlr(SP<COutput> pOutput) {
     m_sc = makeShared<CCZwlrScreencopyFrameV1>(g_pHyprlock->getScreencopy()->sendCaptureOutput(false, pOutput->m_wlOutput->resource()));
 
-    if (*SCMODE == 1)
-        m_frame = makeUnique<CSCSHMFrame>(m_sc);
-    else
-        m_frame = makeUnique<CSCDMAFrame>(m_sc);
+    // wlr-screencopy dictates size and stride, there is one format per buffer type.
+    m_sc->setBuffer([this](CCZwlrScreencopyFrameV1* r, uint32_t format, uint32_t width, uint32_t height, uint32_t stride) {
+        Debug::log(TRACE, "[sc] [shm] wlrOnBuffer for {}", (void*)this);
+
+        m_constraints.w = width;
+        m_constraints.h = height;
+        m_constraints.shm.push_back({.fmt = format, .stride = stride});
+    });
+
+    m_sc->setLinuxDmabuf([this](CCZwlrScreencopyFrameV1* r, uint32_t format, uint32_t width, uint32_t height) {
+        Debug::log(TRACE, "[sc] wlrOnDmabuf for {}", (void*)this);
+        Debug::log(TRACE, "[sc] DMABUF format reported: {:x}", format);
+
+        m_constraints.w = width;
+        m_constraints.h = height;
+        m_constraints.dmabuf.push_back({.fmt = format});
+    });
 
     m_sc->setBufferDone([this](CCZwlrScreencopyFrameV1* r) {
         Debug::log(TRACE, "[sc] wlrOnBufferDone for {}", (void*)this);
 
-        if (!m_frame || !m_frame->onBufferDone() || !m_frame->m_wlBuffer) {
+        if (!createBuffer()) {
             Debug::log(ERR, "[sc] Failed to create a wayland buffer for the screencopy frame");
+            onFailed();
             return;
         }
 
@@ -55,202 +103,248 @@ void CScreencopyFrame::capture(SP<COutput> pOutput) {
     m_sc->setFailed([this](CCZwlrScreencopyFrameV1* r) {
         Debug::log(ERR, "[sc] wlrOnFailed for {}", (void*)r);
 
-        m_frame.reset();
+        onFailed();
     });
 
     m_sc->setReady([this](CCZwlrScreencopyFrameV1* r, uint32_t, uint32_t, uint32_t) {
         Debug::log(TRACE, "[sc] wlrOnReady for {}", (void*)this);
 
-        if (!m_frame || !m_frame->onBufferReady(m_asset)) {
-            Debug::log(ERR, "[sc] Failed to bind the screencopy buffer to a texture");
+        onCopyDone();
+    });
+}
+
+void CScreencopyFrame::captureExt(SP<COutput> pOutput) {
+    m_extSource  = makeShared<CCExtImageCaptureSourceV1>(g_pHyprlock->getOutputCaptureSource()->sendCreateSource(pOutput->m_wlOutput->resource()));
+    m_extSession = makeShared<CCExtImageCopyCaptureSessionV1>(g_pHyprlock->getImageCopyCapture()->sendCreateSession(m_extSource->resource(), (extImageCopyCaptureManagerV1Options)0));
+
+    // The session announces all constraints up front and repeats them with a new done event whenever they change.
+    m_extSession->setBufferSize([this](CCExtImageCopyCaptureSessionV1* r, uint32_t width, uint32_t height) {
+        beginConstraints();
+
+        m_constraints.w = width;
+        m_constraints.h = height;
+    });
+
+    m_extSession->setShmFormat([this](CCExtImageCopyCaptureSessionV1* r, uint32_t format) {
+        beginConstraints();
+
+        m_constraints.shm.push_back({.fmt = format});
+    });
+
+    m_extSession->setDmabufDevice([this](CCExtImageCopyCaptureSessionV1* r, wl_array* device_arr) {
+        beginConstraints();
+
+        dev_t device;
+        if (device_arr->size != sizeof(device)) {
+            m_constraints.dmabufDevice = false;
             return;
         }
 
-        m_sc.reset();
-        m_ready = true;
-        g_asyncResourceManager->screencopyToTexture(*this);
+        memcpy(&device, device_arr->data, sizeof(device));
+        m_constraints.dmabufDevice = g_pHyprlock->isGBMDevice(device);
+        if (!m_constraints.dmabufDevice)
+            Debug::log(LOG, "[sc] Compositor wants dmabufs from another device, using shm");
     });
-}
 
-CSCDMAFrame::CSCDMAFrame(SP<CCZwlrScreencopyFrameV1> sc) : m_sc(sc) {
-    if (!glEGLImageTargetTexture2DOES) {
-        glEGLImageTargetTexture2DOES = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)eglGetProcAddress("glEGLImageTargetTexture2DOES");
-        if (!glEGLImageTargetTexture2DOES) {
-            Debug::log(ERR, "[sc] No glEGLImageTargetTexture2DOES??");
+    m_extSession->setDmabufFormat([this](CCExtImageCopyCaptureSessionV1* r, uint32_t format, wl_array* modifiers) {
+        beginConstraints();
+
+        SConstraints::SDmabuf dmabuf = {.fmt = format};
+
+        const auto*           MODS = (const uint64_t*)modifiers->data;
+        dmabuf.mods.assign(MODS, MODS + (modifiers->size / sizeof(uint64_t)));
+
+        m_constraints.dmabuf.emplace_back(std::move(dmabuf));
+    });
+
+    m_extSession->setDone([this](CCExtImageCopyCaptureSessionV1* r) {
+        Debug::log(TRACE, "[sc] extOnDone for {}", (void*)this);
+
+        m_constraintsDone = true;
+
+        if (m_extFrame)
+            return; // already capturing, we only need one frame
+
+        if (!createBuffer()) {
+            Debug::log(ERR, "[sc] Failed to create a wayland buffer for the screencopy frame");
+            onFailed();
             return;
         }
-    }
 
-    if (!g_pHyprlock->dma.linuxDmabuf) {
-        Debug::log(ERR, "[sc] No DMABUF support?");
-        return;
-    }
+        m_extFrame = makeShared<CCExtImageCopyCaptureFrameV1>(m_extSession->sendCreateFrame());
 
-    if (!g_pHyprlock->dma.gbmDevice) {
-        Debug::log(ERR, "[sc] No gbmDevice for DMABUF was created?");
-        return;
-    }
+        m_extFrame->setFailed([this](CCExtImageCopyCaptureFrameV1* r, uint32_t reason) {
+            Debug::log(ERR, "[sc] extOnFailed for {} with reason {}", (void*)r, reason);
 
-    if (!eglQueryDmaBufModifiersEXT)
-        eglQueryDmaBufModifiersEXT = (PFNEGLQUERYDMABUFMODIFIERSEXTPROC)eglGetProcAddress("eglQueryDmaBufModifiersEXT");
+            onFailed();
+        });
 
-    m_sc->setLinuxDmabuf([this](CCZwlrScreencopyFrameV1* r, uint32_t format, uint32_t width, uint32_t height) {
-        Debug::log(TRACE, "[sc] wlrOnDmabuf for {}", (void*)this);
+        m_extFrame->setReady([this](CCExtImageCopyCaptureFrameV1* r) {
+            Debug::log(TRACE, "[sc] extOnReady for {}", (void*)this);
 
-        m_w   = width;
-        m_h   = height;
-        m_fmt = format;
+            onCopyDone();
+        });
 
-        Debug::log(TRACE, "[sc] DMABUF format reported: {:x}", format);
+        m_extFrame->sendAttachBuffer(m_frame->m_wlBuffer->resource());
+        m_extFrame->sendDamageBuffer(0, 0, m_constraints.w, m_constraints.h);
+        m_extFrame->sendCapture();
+
+        Debug::log(TRACE, "[sc] ext frame captured");
     });
 
-    m_sc->setBuffer([](CCZwlrScreencopyFrameV1* r, uint32_t format, uint32_t width, uint32_t height, uint32_t stride) {
-        ; // unused by dma
+    m_extSession->setStopped([this](CCExtImageCopyCaptureSessionV1* r) {
+        Debug::log(ERR, "[sc] extOnStopped for {}", (void*)r);
+
+        if (!m_ready)
+            onFailed();
     });
 }
 
-CSCDMAFrame::~CSCDMAFrame() {
-    if (g_pEGL)
-        eglDestroyImage(g_pEGL->eglDisplay, m_image);
+bool CScreencopyFrame::createBuffer() {
+    static const auto SCMODE = g_pConfigManager->getValue<Hyprlang::INT>("general:screencopy_mode");
 
-    // leaks bo and stuff but lives throughout so for now who cares
-}
+    m_frame.reset();
 
-bool CSCDMAFrame::onBufferDone() {
-    uint32_t flags = GBM_BO_USE_RENDERING;
-
-    if (!eglQueryDmaBufModifiersEXT) {
-        Debug::log(WARN, "Querying modifiers without eglQueryDmaBufModifiersEXT support");
-        m_bo = gbm_bo_create(g_pHyprlock->dma.gbmDevice, m_w, m_h, m_fmt, flags);
-    } else {
-        std::array<uint64_t, 64>   mods;
-        std::array<EGLBoolean, 64> externalOnly;
-        int                        num = 0;
-        if (!eglQueryDmaBufModifiersEXT(g_pEGL->eglDisplay, m_fmt, 64, mods.data(), externalOnly.data(), &num) || num == 0) {
-            Debug::log(WARN, "eglQueryDmaBufModifiersEXT failed, falling back to regular bo");
-            m_bo = gbm_bo_create(g_pHyprlock->dma.gbmDevice, m_w, m_h, m_fmt, flags);
-        } else {
-            Debug::log(LOG, "eglQueryDmaBufModifiersEXT found {} mods", num);
-            std::vector<uint64_t> goodMods;
-            for (int i = 0; i < num; ++i) {
-                if (externalOnly[i]) {
-                    Debug::log(TRACE, "Modifier {:x} failed test", mods[i]);
-                    continue;
-                }
-
-                Debug::log(TRACE, "Modifier {:x} passed test", mods[i]);
-                goodMods.emplace_back(mods[i]);
-            }
-
-            m_bo = gbm_bo_create_with_modifiers2(g_pHyprlock->dma.gbmDevice, m_w, m_h, m_fmt, goodMods.data(), goodMods.size(), flags);
-        }
+    if (*SCMODE != 1 && !m_constraints.dmabuf.empty() && m_constraints.dmabufDevice) {
+        // Fall back to the compositor's first choice if we have no preference for any of the offered formats.
+        const auto* DMABUF = pickPreferred(m_constraints.dmabuf, DRM_FORMAT_PREFERENCE);
+        if (!DMABUF)
+            DMABUF = &m_constraints.dmabuf.front();
+
+        m_frame = makeUnique<CSCDMAFrame>(m_constraints.w, m_constraints.h, DMABUF->fmt, DMABUF->mods);
+        if (m_frame->onBufferDone() && m_frame->m_wlBuffer)
+            return true;
+
+        Debug::log(WARN, "[sc] Failed to create a dmabuf, falling back to shm");
+        m_frame.reset();
     }
 
-    if (!m_bo) {
-        Debug::log(ERR, "[bo] Couldn't create a drm buffer");
+    const auto* SHM = pickPreferred(m_constraints.shm, SHM_FORMAT_PREFERENCE);
+    if (!SHM) {
+        Debug::log(ERR, "[sc] No supported shm format offered");
         return false;
     }
 
-    m_planes = gbm_bo_get_plane_count(m_bo);
-    Debug::log(LOG, "[bo] has {} plane(s)", m_planes);
+    // Uploads expect tightly packed pixels per row, except for the padding at the end.
+    const uint32_t BPP    = (SHM->fmt == WL_SHM_FORMAT_BGR888 || SHM->fmt == WL_SHM_FORMAT_RGB888) ? 3 : 4;
+    const uint32_t STRIDE = SHM->stride ? SHM->stride : m_constraints.w * BPP;
 
-    m_mod = gbm_bo_get_modifier(m_bo);
-    Debug::log(LOG, "[bo] chose modifier {:x}", m_mod);
+    m_frame = makeUnique<CSCSHMFrame>(m_constraints.w, m_constraints.h, STRIDE, SHM->fmt);
+    if (m_frame->onBufferDone() && m_frame->m_wlBuffer)
+        return true;
 
-    auto params = makeShared<CCZwpLinuxBufferParamsV1>(g_pHyprlock->dma.linuxDmabuf->sendCreateParams());
-    if (!params) {
-        Debug::log(ERR, "zwp_linux_dmabuf_v1_create_params failed");
-        gbm_bo_destroy(m_bo);
-        return false;
+    m_frame.reset();
+    return false;
+}
+
+void CScreencopyFrame::onCopyDone() {
+    // Don't touch this after a successful onBufferReady. The frame is gone once the texture was handed to the resource manager.
+    if (!m_frame || !m_frame->onBufferReady(m_asset, [this]() { onTextureReady(); })) {
+        Debug::log(ERR, "[sc] Failed to bind the screencopy buffer to a texture");
+        onFailed();
     }
+}
 
-    for (size_t plane = 0; plane < (size_t)m_planes; plane++) {
-        m_stride[plane] = gbm_bo_get_stride_for_plane(m_bo, plane);
-        m_offset[plane] = gbm_bo_get_offset(m_bo, plane);
-        m_fd[plane]     = gbm_bo_get_fd_for_plane(m_bo, plane);
-
-        if (m_fd[plane] < 0) {
-            Debug::log(ERR, "gbm_m_bo_get_fd_for_plane failed");
-            params.reset();
-            gbm_bo_destroy(m_bo);
-            for (size_t plane_tmp = 0; plane_tmp < plane; plane_tmp++) {
-                close(m_fd[plane_tmp]);
-            }
-            return false;
-        }
+void CScreencopyFrame::onFailed() {
+    m_frame.reset();
+    // Destroys this, like screencopyToTexture does.
+    g_asyncResourceManager->screencopyFailed(*this);
+}
 
-        params->sendAdd(m_fd[plane], plane, m_offset[plane], m_stride[plane], m_mod >> 32, m_mod & 0xffffffff);
-    }
+void CScreencopyFrame::beginConstraints() {
+    if (!m_constraintsDone)
+        return;
 
-    m_wlBuffer = makeShared<CCWlBuffer>(params->sendCreateImmed(m_w, m_h, m_fmt, (zwpLinuxBufferParamsV1Flags)0));
-    params.reset();
+    m_constraints     = {};
+    m_constraintsDone = false;
+}
 
-    if (!m_wlBuffer) {
-        Debug::log(ERR, "[pw] zwp_linux_buffer_params_v1_create_immed failed");
-        gbm_bo_destroy(m_bo);
-        for (size_t plane = 0; plane < (size_t)m_planes; plane++)
-            close(m_fd[plane]);
+void CScreencopyFrame::onTextureReady() {
+    m_sc.reset();
+    m_extFrame.reset();
+    m_extSession.reset();
+    m_extSource.reset();
 
-        return false;
-    }
+    if (m_scale < 1.F && m_asset->m_iType != TEXTURE_INVALID)
+        downscale();
 
-    return true;
+    m_ready = true;
+    g_asyncResourceManager->screencopyToTexture(*this);
 }
 
-bool CSCDMAFrame::onBufferReady(ASP<CTexture> texture) {
-    static constexpr struct {
-        EGLAttrib fd;
-        EGLAttrib offset;
-        EGLAttrib pitch;
-        EGLAttrib modlo;
-        EGLAttrib modhi;
-    } attrNames[4] = {{.fd     = EGL_DMA_BUF_PLANE0_FD_EXT,
-                       .offset = EGL_DMA_BUF_PLANE0_OFFSET_EXT,
-                       .pitch  = EGL_DMA_BUF_PLANE0_PITCH_EXT,
-                       .modlo  = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
-                       .modhi  = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT},
-                      {.fd     = EGL_DMA_BUF_PLANE1_FD_EXT,
-                       .offset = EGL_DMA_BUF_PLANE1_OFFSET_EXT,
-                       .pitch  = EGL_DMA_BUF_PLANE1_PITCH_EXT,
-                       .modlo  = EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
-                       .modhi  = EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT},
-                      {.fd     = EGL_DMA_BUF_PLANE2_FD_EXT,
-                       .offset = EGL_DMA_BUF_PLANE2_OFFSET_EXT,
-                       .pitch  = EGL_DMA_BUF_PLANE2_PITCH_EXT,
-                       .modlo  = EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
-                       .modhi  = EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT},
-                      {.fd     = EGL_DMA_BUF_PLANE3_FD_EXT,
-                       .offset = EGL_DMA_BUF_PLANE3_OFFSET_EXT,
-                       .pitch  = EGL_DMA_BUF_PLANE3_PITCH_EXT,
-                       .modlo  = EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT,
-                       .modhi  = EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT}};
-
-    std::vector<EGLAttrib> attribs = {
-        EGL_WIDTH, m_w, EGL_HEIGHT, m_h, EGL_LINUX_DRM_FOURCC_EXT, m_fmt,
-    };
-    for (int i = 0; i < m_planes; i++) {
-        attribs.emplace_back(attrNames[i].fd);
-        attribs.emplace_back(m_fd[i]);
-        attribs.emplace_back(attrNames[i].offset);
-        attribs.emplace_back(m_offset[i]);
-        attribs.emplace_back(attrNames[i].pitch);
-        attribs.emplace_back(m_stride[i]);
-        if (m_mod != DRM_FORMAT_MOD_INVALID) {
-            attribs.emplace_back(attrNames[i].modlo);
-            attribs.emplace_back(m_mod & 0xFFFFFFFF);
-            attribs.emplace_back(attrNames[i].modhi);
-            attribs.emplace_back(m_mod >> 32);
+void CScreencopyFrame::downscale() {
+    const Vector2D SIZE = {std::max(1.0, std::floor(m_asset->m_vSize.x * m_scale)), std::max(1.0, std::floor(m_asset->m_vSize.y * m_scale))};
+
+    // Linear sampling at half size averages 2x2 blocks.
+    glBindTexture(GL_TEXTURE_2D, m_asset->m_iTexID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    CFramebuffer fb;
+    fb.alloc(SIZE.x, SIZE.y);
+    fb.bind();
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    g_pRenderer->setOffscreenProjection(SIZE);
+    // Rendering into a framebuffer flips vertically. Flip once more, so the result is oriented like the capture itself.
+    g_pRenderer->renderTexture(CBox{{}, SIZE}, *m_asset, 1, 0, HYPRUTILS_TRANSFORM_FLIPPED_180);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+    // Take the texture over from the framebuffer.
+    auto scaled          = makeAtomicShared<CTexture>();
+    scaled->m_iTexID     = fb.m_cTex.m_iTexID;
+    scaled->m_bAllocated = true;
+    scaled->m_vSize      = SIZE;
+    fb.m_cTex.m_iTexID   = 0;
+
+    Debug::log(LOG, "[sc] Downscaled screenshot from {} to {}", m_asset->m_vSize, SIZE);
+
+    // Releases the full resolution texture and with it the capture buffer.
+    m_asset = scaled;
+}
+
+CSCDMAFrame::CSCDMAFrame(uint32_t w, uint32_t h, uint32_t fmt, std::vector<uint64_t> mods) : m_w(w), m_h(h), m_fmt(fmt), m_mods(std::move(mods)) {
+    Debug::log(TRACE, "[sc] Creating a DMA frame with format {:x}", fmt);
+}
+
+CSCDMAFrame::~CSCDMAFrame() {
+    if (g_asyncResourceManager)
+        g_asyncResourceManager->m_dmaPool.release(m_buffer);
+}
+
+bool CSCDMAFrame::onBufferDone() {
+    if (!glEGLImageTargetTexture2DOES) {
+        glEGLImageTargetTexture2DOES = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)eglGetProcAddress("glEGLImageTargetTexture2DOES");
+        if (!glEGLImageTargetTexture2DOES) {
+            Debug::log(ERR, "[sc] No glEGLImageTargetTexture2DOES??");
+            return false;
         }
     }
-    attribs.emplace_back(EGL_NONE);
 
-    m_image = eglCreateImage(g_pEGL->eglDisplay, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attribs.data());
+    if (!g_pHyprlock->dma.linuxDmabuf) {
+        Debug::log(ERR, "[sc] No DMABUF support?");
+        return false;
+    }
 
-    if (m_image == EGL_NO_IMAGE) {
-        Debug::log(ERR, "Failed creating an egl image");
+    if (!g_pHyprlock->dma.gbmDevice) {
+        Debug::log(ERR, "[sc] No gbmDevice for DMABUF was created?");
         return false;
     }
 
+    m_buffer = g_asyncResourceManager->m_dmaPool.acquire(m_w, m_h, m_fmt, m_mods);
+    if (!m_buffer)
+        return false;
+
+    m_wlBuffer = m_buffer->wlBuffer;
+    return true;
+}
+
+bool CSCDMAFrame::onBufferReady(ASP<CTexture> texture, std::function<void()> onTextureReady) {
+    if (!m_buffer || !g_asyncResourceManager->m_dmaPool.ensureImage(m_buffer))
+        return false;
+
     texture->allocate();
     texture->m_vSize = {m_w, m_h};
     glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
@@ -258,220 +352,101 @@ bool CSCDMAFrame::onBufferReady(ASP<CTexture> texture) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, m_image);
+    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, m_buffer->image);
     glBindTexture(GL_TEXTURE_2D, 0);
 
+    // The texture samples straight from the bo, it can't be handed to another capture until the texture is gone.
+    m_buffer->texture = texture;
+
     Debug::log(LOG, "Got dma frame with size {}", texture->m_vSize);
 
+    onTextureReady();
     return true;
 }
 
-CSCSHMFrame::CSCSHMFrame(SP<CCZwlrScreencopyFrameV1> sc) : m_sc(sc) {
-    Debug::log(TRACE, "[sc] [shm] Creating a SHM frame");
-
-    m_sc->setBuffer([this](CCZwlrScreencopyFrameV1* r, uint32_t format, uint32_t width, uint32_t height, uint32_t stride) {
-        Debug::log(TRACE, "[sc] [shm] wlrOnBuffer for {}", (void*)this);
-
-        const auto SIZE = stride * height;
-        m_shmFmt        = format;
-        m_w             = width;
-        m_h             = height;
-        m_stride        = stride;
-
-        // Create a shm pool with format and size
-        std::string shmPoolFile;
-        const auto  FD = createPoolFile(SIZE, shmPoolFile);
-
-        if (FD < 0) {
-            Debug::log(ERR, "[sc] [shm] failed to create a pool file");
-            return;
-        }
-
-        m_shmData = mmap(nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, FD, 0);
-        if (m_shmData == MAP_FAILED) {
-            Debug::log(ERR, "[sc] [shm] failed to (errno {})", strerror(errno));
-            close(FD);
-            m_ok = false;
-            return;
-        }
+CSCSHMFrame::CSCSHMFrame(uint32_t w, uint32_t h, uint32_t stride, uint32_t fmt) : m_w(w), m_h(h), m_stride(stride), m_shmFmt(fmt) {
+    Debug::log(TRACE, "[sc] [shm] Creating a SHM frame with format {}", fmt);
+}
 
-        if (!g_pHyprlock->getShm()) {
-            Debug::log(ERR, "[sc] [shm] Failed to get WLShm global");
-            close(FD);
-            m_ok = false;
-            return;
-        }
+bool CSCSHMFrame::onBufferDone() {
+    m_buffer = g_asyncResourceManager->m_shmPool.acquire(m_w, m_h, m_stride, m_shmFmt);
+    if (!m_buffer) {
+        Debug::log(ERR, "[sc] [shm] Failed to get a shm buffer");
+        return false;
+    }
 
-        auto pShmPool = makeShared<CCWlShmPool>(g_pHyprlock->getShm()->sendCreatePool(FD, SIZE));
-        m_wlBuffer    = makeShared<CCWlBuffer>(pShmPool->sendCreateBuffer(0, width, height, stride, m_shmFmt));
+    m_shmData  = m_buffer->data;
+    m_wlBuffer = m_buffer->wlBuffer;
+    return true;
+}
 
-        pShmPool.reset();
+CSCSHMFrame::~CSCSHMFrame() {
+    if (g_asyncResourceManager)
+        g_asyncResourceManager->m_shmPool.release(m_buffer);
+}
 
-        close(FD);
-    });
+// Describes how to upload a shm format as is. Channel order and missing alpha are fixed up by the texture swizzle.
+static bool shmUploadFormat(uint32_t fmt, CTextureUploader::SUpload& upload) {
+    switch (fmt) {
+        // 8 bits per channel. ARGB in little-endian is BGRA in memory.
+        case WL_SHM_FORMAT_ARGB8888:
+        case WL_SHM_FORMAT_XRGB8888: upload.swizzle = {GL_BLUE, GL_GREEN, GL_RED, GL_ALPHA}; break;
+        case WL_SHM_FORMAT_ABGR8888:
+        case WL_SHM_FORMAT_XBGR8888: break;
+        // 10 bits per channel. GL_UNSIGNED_INT_2_10_10_10_REV reads red from the lowest bits, which matches ABGR.
+        case WL_SHM_FORMAT_ARGB2101010:
+        case WL_SHM_FORMAT_XRGB2101010:
+        case WL_SHM_FORMAT_ABGR2101010:
+        case WL_SHM_FORMAT_XBGR2101010: {
+            upload.internalFormat = GL_RGB10_A2;
+            upload.type           = GL_UNSIGNED_INT_2_10_10_10_REV;
+            if (fmt == WL_SHM_FORMAT_ARGB2101010 || fmt == WL_SHM_FORMAT_XRGB2101010)
+                upload.swizzle = {GL_BLUE, GL_GREEN, GL_RED, GL_ALPHA};
+        } break;
+        // 24 bits. BGR888 is RGB in memory.
+        case WL_SHM_FORMAT_RGB888:
+        case WL_SHM_FORMAT_BGR888: {
+            upload.bytesPerPixel  = 3;
+            upload.internalFormat = GL_RGB8;
+            upload.format         = GL_RGB;
+            if (fmt == WL_SHM_FORMAT_RGB888)
+                upload.swizzle = {GL_BLUE, GL_GREEN, GL_RED, GL_ALPHA};
+        } break;
+        default: return false;
+    }
 
-    m_sc->setLinuxDmabuf([](CCZwlrScreencopyFrameV1* r, uint32_t, uint32_t, uint32_t) {
-        ; // unused by scshm
-    });
-}
+    if (fmt == WL_SHM_FORMAT_XRGB8888 || fmt == WL_SHM_FORMAT_XBGR8888 || fmt == WL_SHM_FORMAT_XRGB2101010 || fmt == WL_SHM_FORMAT_XBGR2101010)
+        upload.swizzle[3] = GL_ONE;
 
-CSCSHMFrame::~CSCSHMFrame() {
-    if (m_convBuffer)
-        free(m_convBuffer);
-    if (m_shmData)
-        munmap(m_shmData, m_stride * m_h);
+    return true;
 }
 
-void CSCSHMFrame::convertBuffer() {
-    const auto BYTESPERPX = m_stride / m_w;
-    if (BYTESPERPX == 4) {
-        switch (m_shmFmt) {
-            case WL_SHM_FORMAT_ARGB8888:
-            case WL_SHM_FORMAT_XRGB8888: {
-                Debug::log(LOG, "[sc] [shm] Converting ARGB to RGBA");
-                uint8_t* data = (uint8_t*)m_shmData;
-
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        struct pixel {
-                            // little-endian ARGB
-                            unsigned char blue;
-                            unsigned char green;
-                            unsigned char red;
-                            unsigned char alpha;
-                        }* px = (struct pixel*)(data + (y * m_w * 4) + (x * 4));
-
-                        // RGBA
-                        *px = {.blue = px->red, .green = px->green, .red = px->blue, .alpha = px->alpha};
-                    }
-                }
-            } break;
-            case WL_SHM_FORMAT_ABGR8888:
-            case WL_SHM_FORMAT_XBGR8888: {
-                Debug::log(LOG, "[sc] [shm] Converting ABGR to RGBA");
-                uint8_t* data = (uint8_t*)m_shmData;
-
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        struct pixel {
-                            // little-endian ARGB
-                            unsigned char blue;
-                            unsigned char green;
-                            unsigned char red;
-                            unsigned char alpha;
-                        }* px = (struct pixel*)(data + (y * m_w * 4) + (x * 4));
-
-                        // BGRA
-                        *px = {.blue = px->blue, .green = px->green, .red = px->red, .alpha = px->alpha};
-                    }
-                }
-            } break;
-            case WL_SHM_FORMAT_ABGR2101010:
-            case WL_SHM_FORMAT_ARGB2101010:
-            case WL_SHM_FORMAT_XRGB2101010:
-            case WL_SHM_FORMAT_XBGR2101010: {
-                Debug::log(LOG, "[sc] [shm] Converting 10-bit channels to 8-bit");
-                uint8_t*   data = (uint8_t*)m_shmData;
-
-                const bool FLIP = m_shmFmt != WL_SHM_FORMAT_XBGR2101010;
-
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        uint32_t* px = (uint32_t*)(data + (y * m_w * 4) + (x * 4));
-
-                        // conv to 8 bit
-                        uint8_t R = (uint8_t)std::round((255.0 * (((*px) & 0b00000000000000000000001111111111) >> 0) / 1023.0));
-                        uint8_t G = (uint8_t)std::round((255.0 * (((*px) & 0b00000000000011111111110000000000) >> 10) / 1023.0));
-                        uint8_t B = (uint8_t)std::round((255.0 * (((*px) & 0b00111111111100000000000000000000) >> 20) / 1023.0));
-                        uint8_t A = (uint8_t)std::round((255.0 * (((*px) & 0b11000000000000000000000000000000) >> 30) / 3.0));
-
-                        // write 8-bit values
-                        *px = ((FLIP ? B : R) << 0) + (G << 8) + ((FLIP ? R : B) << 16) + (A << 24);
-                    }
-                }
-            } break;
-            default: {
-                Debug::log(WARN, "[sc] [shm] Unsupported format {}", m_shmFmt);
-            }
-        }
-    } else if (BYTESPERPX == 3) {
-        Debug::log(LOG, "[sc] [shm] Converting 24 bit to 32 bit");
-        m_convBuffer        = malloc(m_w * m_h * 4);
-        const int NEWSTRIDE = m_w * 4;
-        RASSERT(m_convBuffer, "malloc failed");
-
-        switch (m_shmFmt) {
-            case WL_SHM_FORMAT_BGR888: {
-                Debug::log(LOG, "[sc] [shm] Converting BGR to RGBA");
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        struct pixel3 {
-                            // little-endian RGB
-                            unsigned char blue;
-                            unsigned char green;
-                            unsigned char red;
-                        }* srcPx = (struct pixel3*)((char*)m_shmData + (y * m_stride) + (x * 3));
-                        struct pixel4 {
-                            // little-endian ARGB
-                            unsigned char blue;
-                            unsigned char green;
-                            unsigned char red;
-                            unsigned char alpha;
-                        }* dstPx = (struct pixel4*)((char*)m_convBuffer + (y * NEWSTRIDE) + (x * 4));
-                        *dstPx   = {.blue = srcPx->blue, .green = srcPx->green, .red = srcPx->red, .alpha = 0xFF};
-                    }
-                }
-            } break;
-            case WL_SHM_FORMAT_RGB888: {
-                Debug::log(LOG, "[sc] [shm] Converting RGB to RGBA");
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        struct pixel3 {
-                            // big-endian RGB
-                            unsigned char red;
-                            unsigned char green;
-                            unsigned char blue;
-                        }* srcPx = (struct pixel3*)((char*)m_shmData + (y * m_stride) + (x * 3));
-                        struct pixel4 {
-                            // big-endian ARGB
-                            unsigned char alpha;
-                            unsigned char red;
-                            unsigned char green;
-                            unsigned char blue;
-                        }* dstPx = (struct pixel4*)((char*)m_convBuffer + (y * NEWSTRIDE) + (x * 4));
-                        *dstPx   = {.alpha = srcPx->red, .red = srcPx->green, .green = srcPx->blue, .blue = 0xFF};
-                    }
-                }
-            } break;
-            default: {
-                Debug::log(ERR, "[sc] [shm] Unsupported format for 24bit buffer {}", m_shmFmt);
-            }
-        }
+bool CSCSHMFrame::onBufferReady(ASP<CTexture> texture, std::function<void()> onTextureReady) {
+    // m_buffer stays acquired by this frame, which lives until onTextureReady handed the texture over.
+    CTextureUploader::SUpload upload = {
+        .texture = texture,
+        .data    = (const uint8_t*)m_shmData,
+        .stride  = m_stride,
+        .filter  = GL_NEAREST,
+        .onDone  = std::move(onTextureReady),
+    };
 
-    } else {
-        Debug::log(ERR, "[sc] [shm] Unsupported bytes per pixel {}", BYTESPERPX);
+    if (!shmUploadFormat(m_shmFmt, upload)) {
+        Debug::log(ERR, "[sc] [shm] Unsupported format {}", m_shmFmt);
+        return false;
     }
-}
 
-bool CSCSHMFrame::onBufferReady(ASP<CTexture> texture) {
-    convertBuffer();
+    if (m_stride < m_w * upload.bytesPerPixel) {
+        Debug::log(ERR, "[sc] [shm] Stride {} too small for format {} with width {}", m_stride, m_shmFmt, m_w);
+        return false;
+    }
 
-    texture->allocate();
     texture->m_vSize.x = m_w;
     texture->m_vSize.y = m_h;
 
-    glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
-
-    void* buffer = m_convBuffer ? m_convBuffer : m_shmData;
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_w, m_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
     Debug::log(LOG, "[sc] [shm] Got screenshot with size {}", texture->m_vSize);
 
+    g_asyncResourceManager->m_uploader.enqueue(std::move(upload));
+
     return true;
 }
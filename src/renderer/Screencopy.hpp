@@ -3,90 +3,122 @@
 #include "../defines.hpp"
 #include "../core/Output.hpp"
 #include "../renderer/Texture.hpp"
+#include "../renderer/ShmBufferPool.hpp"
+#include "../renderer/DmaBufferPool.hpp"
 #include <cstdint>
+#include <functional>
 #include <gbm.h>
+#include <vector>
 #include "linux-dmabuf-v1.hpp"
 #include "wlr-screencopy-unstable-v1.hpp"
+#include "ext-image-capture-source-v1.hpp"
+#include "ext-image-copy-capture-v1.hpp"
 
 class ISCFrame {
   public:
     ISCFrame()          = default;
     virtual ~ISCFrame() = default;
 
-    virtual bool   onBufferDone()                     = 0;
-    virtual bool   onBufferReady(ASP<CTexture> asset) = 0;
+    virtual bool onBufferDone() = 0;
+    // onTextureReady gets called once the asset can be sampled. That may happen before this returns.
+    virtual bool   onBufferReady(ASP<CTexture> asset, std::function<void()> onTextureReady) = 0;
 
     SP<CCWlBuffer> m_wlBuffer = nullptr;
 };
 
+// Captures one output via ext-image-copy-capture if the compositor supports it, wlr-screencopy otherwise.
 class CScreencopyFrame {
   public:
     CScreencopyFrame()  = default;
     ~CScreencopyFrame() = default;
 
-    void                        capture(SP<COutput> pOutput);
+    // scale < 1 downscales the captured frame once it arrived and drops the full resolution texture.
+    void          capture(SP<COutput> pOutput, float scale = 1.F);
+    void          onTextureReady();
 
-    SP<CCZwlrScreencopyFrameV1> m_sc = nullptr;
+    ResourceID    m_resourceID;
+    ASP<CTexture> m_asset;
 
-    size_t                      m_resourceID;
-    ASP<CTexture>               m_asset;
-
-    bool                        m_ready = false;
+    bool          m_ready = false;
 
   private:
-    UP<ISCFrame> m_frame = nullptr;
-
-    bool         m_dmaFailed = false;
+    // Buffer types and formats the compositor accepts for the capture.
+    struct SConstraints {
+        uint32_t w = 0, h = 0;
+
+        struct SShm {
+            uint32_t fmt    = 0;
+            uint32_t stride = 0; // 0 if we get to choose
+        };
+        std::vector<SShm> shm;
+
+        struct SDmabuf {
+            uint32_t              fmt = 0;
+            std::vector<uint64_t> mods; // empty if any modifier goes
+        };
+        std::vector<SDmabuf> dmabuf;
+        // False if the compositor wants dmabufs from a device other than the one we allocate from.
+        bool dmabufDevice = true;
+    };
+
+    // Creates m_frame with a buffer for the cheapest format in m_constraints.
+    bool                               createBuffer();
+    void                               captureWlr(SP<COutput> pOutput);
+    void                               captureExt(SP<COutput> pOutput);
+    void                               onCopyDone();
+    // Drops the capture and tells the resource manager not to wait for it. Destroys this.
+    void                               onFailed();
+    // ext sessions resend all constraints after a done event. Forgets the previous set on the first one.
+    void                               beginConstraints();
+    void                               downscale();
+
+    SConstraints                       m_constraints;
+    bool                               m_constraintsDone = false;
+
+    SP<CCZwlrScreencopyFrameV1>        m_sc = nullptr;
+
+    SP<CCExtImageCaptureSourceV1>      m_extSource  = nullptr;
+    SP<CCExtImageCopyCaptureSessionV1> m_extSession = nullptr;
+    SP<CCExtImageCopyCaptureFrameV1>   m_extFrame   = nullptr;
+
+    UP<ISCFrame>                       m_frame = nullptr;
+
+    float                              m_scale = 1.F;
 };
 
-// Uses a gpu buffer created via gbm_bo
+// Uses a gpu buffer created via gbm_bo, taken from CDmaBufferPool
 class CSCDMAFrame : public ISCFrame {
   public:
-    CSCDMAFrame(SP<CCZwlrScreencopyFrameV1> sc);
+    // An empty mods allows any modifier.
+    CSCDMAFrame(uint32_t w, uint32_t h, uint32_t fmt, std::vector<uint64_t> mods);
     virtual ~CSCDMAFrame();
 
-    virtual bool onBufferReady(ASP<CTexture> asset);
+    virtual bool onBufferReady(ASP<CTexture> asset, std::function<void()> onTextureReady);
     virtual bool onBufferDone();
 
   private:
-    gbm_bo*                     m_bo = nullptr;
-
-    int                         m_planes = 0;
-    uint64_t                    m_mod    = 0;
-
-    int                         m_fd[4];
-    uint32_t                    m_stride[4], m_offset[4];
-
-    int                         m_w = 0, m_h = 0;
-    uint32_t                    m_fmt = 0;
+    int                   m_w = 0, m_h = 0;
+    uint32_t              m_fmt = 0;
+    std::vector<uint64_t> m_mods;
 
-    SP<CCZwlrScreencopyFrameV1> m_sc = nullptr;
-
-    EGLImage                    m_image = nullptr;
+    SP<SDmaBuffer>        m_buffer = nullptr;
 };
 
-// Uses a shm buffer - is slow and needs ugly format conversion
+// Uses a shm buffer - is slow, the pixels go through the cpu
 // Used as a fallback just in case.
 class CSCSHMFrame : public ISCFrame {
   public:
-    CSCSHMFrame(SP<CCZwlrScreencopyFrameV1> sc);
+    CSCSHMFrame(uint32_t w, uint32_t h, uint32_t stride, uint32_t fmt);
     virtual ~CSCSHMFrame();
 
-    virtual bool onBufferDone() {
-        return m_ok;
-    }
-    virtual bool onBufferReady(ASP<CTexture> texture);
-    void         convertBuffer();
+    virtual bool onBufferDone();
+    virtual bool onBufferReady(ASP<CTexture> texture, std::function<void()> onTextureReady);
 
   private:
-    bool                        m_ok = true;
-
-    uint32_t                    m_w = 0, m_h = 0;
-    uint32_t                    m_stride = 0;
-
-    SP<CCZwlrScreencopyFrameV1> m_sc = nullptr;
+    uint32_t       m_w = 0, m_h = 0;
+    uint32_t       m_stride = 0;
 
-    uint32_t                    m_shmFmt     = 0;
-    void*                       m_shmData    = nullptr;
-    void*                       m_convBuffer = nullptr;
+    uint32_t       m_shmFmt  = 0;
+    void*          m_shmData = nullptr;
+    SP<SShmBuffer> m_buffer  = nullptr;
 };
@@ -489,11 +489,11 @@ vec4 getOkColorForCoordArray2(vec2 normalizedCoord) {
 
     if (angle2 > 4.71 /* 270 deg */) {
         normalizedCoord[1] = 1.0 - normalizedCoord[1];
-        finalAng = 6.28 - angle;
+        finalAng = 6.28 - angle2;
     } else if (angle2 > 3.14 /* 180 deg */) {
         normalizedCoord[0] = 1.0 - normalizedCoord[0];
         normalizedCoord[1] = 1.0 - normalizedCoord[1];
-        finalAng = angle - 3.14;
+        finalAng = angle2 - 3.14;
     } else if (angle2 > 1.57 /* 90 deg */) {
         normalizedCoord[0] = 1.0 - normalizedCoord[0];
         finalAng = 3.14 - angle2;
@@ -0,0 +1,96 @@
+#include "ShmBufferPool.hpp"
+#include "../core/hyprlock.hpp"
+#include "../helpers/Log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <hyprutils/os/FileDescriptor.hpp>
+
+using namespace Hyprutils::OS;
+
+SShmBuffer::~SShmBuffer() {
+    wlBuffer.reset();
+
+    if (data && data != MAP_FAILED)
+        munmap(data, size);
+}
+
+SP<SShmBuffer> CShmBufferPool::acquire(uint32_t w, uint32_t h, uint32_t stride, uint32_t fmt) {
+    const auto IT = std::ranges::find_if(m_buffers, [&](const auto& b) { return !b->busy && b->w == w && b->h == h && b->stride == stride && b->fmt == fmt; });
+
+    if (IT != m_buffers.end()) {
+        Debug::log(TRACE, "[shm] Reusing buffer {}x{} fmt {}", w, h, fmt);
+        (*IT)->busy = true;
+        return *IT;
+    }
+
+    auto buffer = create(w, h, stride, fmt);
+    if (!buffer)
+        return nullptr;
+
+    buffer->busy = true;
+    m_buffers.emplace_back(buffer);
+    return buffer;
+}
+
+void CShmBufferPool::release(const SP<SShmBuffer>& buffer) {
+    if (buffer)
+        buffer->busy = false;
+}
+
+void CShmBufferPool::trim() {
+    const auto BEFORE = m_buffers.size();
+    std::erase_if(m_buffers, [](const auto& b) { return !b->busy; });
+
+    if (BEFORE != m_buffers.size())
+        Debug::log(TRACE, "[shm] Freed {} idle buffer(s)", BEFORE - m_buffers.size());
+}
+
+SP<SShmBuffer> CShmBufferPool::create(uint32_t w, uint32_t h, uint32_t stride, uint32_t fmt) {
+    if (!g_pHyprlock->getShm()) {
+        Debug::log(ERR, "[shm] Failed to get WLShm global");
+        return nullptr;
+    }
+
+    const size_t    SIZE = (size_t)stride * h;
+
+    CFileDescriptor fd{memfd_create("hyprlock-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING)};
+    if (!fd.isValid()) {
+        Debug::log(ERR, "[shm] memfd_create failed ({})", strerror(errno));
+        return nullptr;
+    }
+
+    if (ftruncate(fd.get(), SIZE) < 0) {
+        Debug::log(ERR, "[shm] ftruncate failed ({})", strerror(errno));
+        return nullptr;
+    }
+
+    // The compositor maps it too. Make sure nobody can shrink it under us.
+    if (fcntl(fd.get(), F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)
+        Debug::log(WARN, "[shm] Failed to seal memfd ({})", strerror(errno));
+
+    auto buffer    = makeShared<SShmBuffer>();
+    buffer->size   = SIZE;
+    buffer->w      = w;
+    buffer->h      = h;
+    buffer->stride = stride;
+    buffer->fmt    = fmt;
+
+    // Fault the pages in now, so the copy doesn't take a page fault for every 4k.
+    buffer->data = mmap(nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd.get(), 0);
+    if (buffer->data == MAP_FAILED) {
+        Debug::log(ERR, "[shm] mmap failed ({})", strerror(errno));
+        return nullptr;
+    }
+
+    // The pool can go right away, the buffer keeps the compositor's mapping alive.
+    auto pool        = makeShared<CCWlShmPool>(g_pHyprlock->getShm()->sendCreatePool(fd.get(), SIZE));
+    buffer->wlBuffer = makeShared<CCWlBuffer>(pool->sendCreateBuffer(0, w, h, stride, fmt));
+    pool.reset();
+
+    Debug::log(LOG, "[shm] Created buffer {}x{} stride {} fmt {}", w, h, stride, fmt);
+
+    return buffer;
+}
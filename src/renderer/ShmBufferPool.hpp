@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "wayland.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A wl_shm buffer backed by a sealed memfd. Owned by CShmBufferPool.
+struct SShmBuffer {
+    ~SShmBuffer();
+
+    void*          data = nullptr;
+    size_t         size = 0;
+
+    uint32_t       w = 0, h = 0, stride = 0, fmt = 0;
+
+    SP<CCWlBuffer> wlBuffer = nullptr;
+    bool           busy     = false;
+};
+
+// Hands out shm buffers for screencopy. Buffers are backed by memfds instead of files in XDG_RUNTIME_DIR,
+// are pre-faulted when created and get reused for later captures with the same layout once released.
+class CShmBufferPool {
+  public:
+    // Returns nullptr on failure.
+    SP<SShmBuffer> acquire(uint32_t w, uint32_t h, uint32_t stride, uint32_t fmt);
+    void           release(const SP<SShmBuffer>& buffer);
+    // Frees all buffers that are not in use.
+    void           trim();
+
+  private:
+    SP<SShmBuffer>              create(uint32_t w, uint32_t h, uint32_t stride, uint32_t fmt);
+
+    std::vector<SP<SShmBuffer>> m_buffers;
+};
@@ -13,7 +13,8 @@ void CTexture::destroyTexture() {
         glDeleteTextures(1, &m_iTexID);
         m_iTexID = 0;
     }
-    m_bAllocated = false;
+    m_bAllocated      = false;
+    m_iInternalFormat = 0;
 }
 
 void CTexture::allocate() {
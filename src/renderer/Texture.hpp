@@ -18,9 +18,10 @@ class CTexture {
     void        destroyTexture();
     void        allocate();
 
-    TEXTURETYPE m_iType      = TEXTURE_RGBA;
-    GLenum      m_iTarget    = GL_TEXTURE_2D;
-    bool        m_bAllocated = false;
-    GLuint      m_iTexID     = 0;
+    TEXTURETYPE m_iType           = TEXTURE_RGBA;
+    GLenum      m_iTarget         = GL_TEXTURE_2D;
+    bool        m_bAllocated      = false;
+    GLuint      m_iTexID          = 0;
+    GLint       m_iInternalFormat = 0; // set once CTextureUploader allocated the storage
     Vector2D    m_vSize;
 };
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "TexturePool.hpp"
+#include "../helpers/Log.hpp"
+#include <algorithm>
+
+// Enough for a handful of ticking labels.
+constexpr size_t MAX_POOLED_TEXTURES = 8;
+
+ASP<CTexture> CTexturePool::take(const Vector2D& size, GLint internalFormat) {
+    // Most recently released first, it is the most likely to still be warm.
+    const auto IT = std::find_if(m_textures.rbegin(), m_textures.rend(),
+                                 [&](const auto& t) { return t.strongRef() == 1 && t->m_vSize == size && t->m_iInternalFormat == internalFormat; });
+    if (IT == m_textures.rend())
+        return nullptr;
+
+    auto texture = std::move(*IT);
+    m_textures.erase(std::next(IT).base());
+
+    Debug::log(TRACE, "[texpool] Reusing texture {} with size {}", texture->m_iTexID, size);
+    return texture;
+}
+
+void CTexturePool::put(ASP<CTexture>&& texture) {
+    if (!texture || !texture->m_bAllocated || texture->m_iType != TEXTURE_RGBA || texture->m_iInternalFormat == 0)
+        return;
+
+    if (m_textures.size() >= MAX_POOLED_TEXTURES)
+        m_textures.pop_front();
+
+    m_textures.emplace_back(std::move(texture));
+}
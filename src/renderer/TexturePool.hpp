@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "./Texture.hpp"
+#include <deque>
+
+// Keeps the textures of released assets around, so that the next asset with the same size and format can reuse their storage.
+// Labels that update every second end up alternating between two texture objects instead of allocating a new one each time.
+// Released textures can still be held elsewhere, e.g. a widget drawing the old asset until the new one arrives.
+// take() only hands out textures the pool holds the last reference to, as their content will be replaced.
+class CTexturePool {
+  public:
+    CTexturePool() = default;
+
+    // A texture with storage for size and internalFormat that nobody else holds, or nullptr.
+    ASP<CTexture> take(const Vector2D& size, GLint internalFormat);
+    void          put(ASP<CTexture>&& texture);
+
+  private:
+    // Oldest first.
+    std::deque<ASP<CTexture>> m_textures;
+};
@@ -0,0 +1,171 @@
+#include "TextureUploader.hpp"
+#include "../core/hyprlock.hpp"
+#include "../helpers/Log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <GLES3/gl32.h>
+
+// Roughly what a slow iGPU moves within a couple of milliseconds.
+constexpr size_t UPLOAD_BYTES_PER_PUMP = 8 * 1024 * 1024;
+// Spread chunks over frames instead of draining the queue in one go.
+constexpr auto UPLOAD_PUMP_INTERVAL = std::chrono::milliseconds(4);
+
+CTextureUploader::~CTextureUploader() {
+    for (auto& job : m_jobs) {
+        destroyJob(job);
+    }
+}
+
+void CTextureUploader::enqueue(SUpload&& upload) {
+    RASSERT(upload.texture && upload.data, "CTextureUploader::enqueue without a texture or data");
+
+    if (upload.texture->m_vSize.x < 1 || upload.texture->m_vSize.y < 1) {
+        Debug::log(ERR, "[upload] Refusing to upload a texture with size {}", upload.texture->m_vSize);
+        upload.texture->m_iType = TEXTURE_INVALID;
+        if (upload.onDone)
+            upload.onDone();
+        return;
+    }
+
+    m_jobs.emplace_back(SJob{.upload = std::move(upload)});
+    schedulePump(true);
+}
+
+bool CTextureUploader::busy() const {
+    return !m_jobs.empty();
+}
+
+void CTextureUploader::schedulePump(bool immediate) {
+    if (m_pumpScheduled)
+        return;
+
+    m_pumpScheduled = true;
+    g_pHyprlock->addTimer(immediate ? std::chrono::milliseconds(0) : UPLOAD_PUMP_INTERVAL, [this](auto, auto) {
+        m_pumpScheduled = false;
+        if (pump())
+            schedulePump(false);
+    }, nullptr);
+}
+
+bool CTextureUploader::pump() {
+    size_t budget = UPLOAD_BYTES_PER_PUMP;
+
+    // Completed jobs are taken out before calling onDone, as it may enqueue more work.
+    std::vector<SJob> done;
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        auto& job = *it;
+
+        if (job.fence) {
+            const auto RESULT = glClientWaitSync(job.fence, 0, 0);
+            if (RESULT == GL_ALREADY_SIGNALED || RESULT == GL_CONDITION_SATISFIED) {
+                done.emplace_back(std::move(job));
+                it = m_jobs.erase(it);
+                continue;
+            }
+
+            if (RESULT == GL_WAIT_FAILED)
+                Debug::log(ERR, "[upload] glClientWaitSync failed, waiting for the next pump");
+
+            ++it;
+            continue;
+        }
+
+        if (budget > 0)
+            budget -= std::min(budget, uploadChunk(job, budget));
+
+        ++it;
+    }
+
+    for (auto& job : done) {
+        Debug::log(TRACE, "[upload] Texture {} with size {} done", job.upload.texture->m_iTexID, job.upload.texture->m_vSize);
+        destroyJob(job);
+        if (job.upload.onDone)
+            job.upload.onDone();
+    }
+
+    return !m_jobs.empty();
+}
+
+size_t CTextureUploader::uploadChunk(SJob& job, size_t budget) {
+    auto&        upload   = job.upload;
+    const auto&  TEXTURE  = upload.texture;
+    const size_t WIDTH    = TEXTURE->m_vSize.x;
+    const size_t HEIGHT   = TEXTURE->m_vSize.y;
+    const size_t ROWBYTES = WIDTH * upload.bytesPerPixel;
+    const size_t ROWS     = std::clamp<size_t>(budget / std::max<size_t>(ROWBYTES, 1), 1, HEIGHT - job.nextRow);
+
+    if (job.nextRow == 0) {
+        // Recycled textures already have storage of the right size and format, only their pixels get replaced.
+        const bool HASSTORAGE = TEXTURE->m_bAllocated && TEXTURE->m_iInternalFormat == upload.internalFormat;
+
+        TEXTURE->allocate();
+        glBindTexture(GL_TEXTURE_2D, TEXTURE->m_iTexID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, upload.filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, upload.filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, upload.swizzle[0]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, upload.swizzle[1]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, upload.swizzle[2]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, upload.swizzle[3]);
+        if (!HASSTORAGE) {
+            glTexImage2D(GL_TEXTURE_2D, 0, upload.internalFormat, WIDTH, HEIGHT, 0, upload.format, upload.type, nullptr);
+            TEXTURE->m_iInternalFormat = upload.internalFormat;
+        }
+
+        glGenBuffers(1, &job.pbo);
+    } else
+        glBindTexture(GL_TEXTURE_2D, TEXTURE->m_iTexID);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job.pbo);
+    // Orphan the previous chunk's storage instead of waiting for the GPU to be done reading it.
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, ROWS * ROWBYTES, nullptr, GL_STREAM_DRAW);
+
+    auto* dst = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ROWS * ROWBYTES, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!dst) {
+        Debug::log(ERR, "[upload] Failed to map a pixel unpack buffer, retrying next pump");
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return 0;
+    }
+
+    const auto* SRC = upload.data + (job.nextRow * upload.stride);
+    if (upload.stride == ROWBYTES)
+        std::memcpy(dst, SRC, ROWS * ROWBYTES);
+    else {
+        for (size_t row = 0; row < ROWS; ++row) {
+            std::memcpy(dst + (row * ROWBYTES), SRC + (row * upload.stride), ROWBYTES);
+        }
+    }
+
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // Rows are tightly packed in the PBO. 3 byte formats would break the default alignment of 4.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job.nextRow, WIDTH, ROWS, upload.format, upload.type, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    job.nextRow += ROWS;
+    if (job.nextRow >= HEIGHT) {
+        job.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+    }
+
+    return ROWS * ROWBYTES;
+}
+
+void CTextureUploader::destroyJob(SJob& job) {
+    if (job.fence) {
+        glDeleteSync(job.fence);
+        job.fence = nullptr;
+    }
+
+    if (job.pbo) {
+        glDeleteBuffers(1, &job.pbo);
+        job.pbo = 0;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "Texture.hpp"
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// Streams pixel data into textures through pixel unpack buffers.
+// Each pump copies a bounded number of rows into a mapped PBO and issues the texture upload from it,
+// so big images get spread over multiple pumps instead of stalling the main thread.
+// A texture is handed out via onDone only after the fence behind its last chunk signalled.
+class CTextureUploader {
+  public:
+    CTextureUploader() = default;
+    ~CTextureUploader();
+
+    struct SUpload {
+        ASP<CTexture> texture;
+        // Must stay valid until onDone was called or the upload got dropped. Capture the owner in onDone.
+        const uint8_t*        data           = nullptr;
+        size_t                stride         = 0;
+        size_t                bytesPerPixel  = 4;
+        GLint                 internalFormat = GL_RGBA;
+        GLenum                format         = GL_RGBA;
+        GLenum                type           = GL_UNSIGNED_BYTE;
+        std::array<GLint, 4>  swizzle        = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+        GLint                 filter         = GL_LINEAR;
+        std::function<void()> onDone;
+    };
+
+    // texture->m_vSize has to be set. A texture that already has storage with that size and format gets reused.
+    void enqueue(SUpload&& upload);
+    // Uploads the next chunks and completes finished uploads. Returns whether work is left.
+    bool pump();
+    bool busy() const;
+
+  private:
+    struct SJob {
+        SUpload upload;
+        size_t  nextRow = 0;
+        GLuint  pbo     = 0;
+        GLsync  fence   = nullptr;
+    };
+
+    void             schedulePump(bool immediate);
+    // Returns the number of bytes copied.
+    size_t           uploadChunk(SJob& job, size_t budget);
+    static void      destroyJob(SJob& job);
+
+    std::deque<SJob> m_jobs;
+    bool             m_pumpScheduled = false;
+};
@@ -0,0 +1,199 @@
+#include "PackedResource.hpp"
+
+#include "../../helpers/Log.hpp"
+#include <hyprgraphics/cairo/CairoSurface.hpp>
+#include <algorithm>
+#include <bit>
+#include <cairo/cairo.h>
+#include <cmath>
+#include <cstring>
+
+using namespace Hyprgraphics;
+
+CPackedResource::CPackedResource(const ASP<IAsyncResource>& resource) : m_resource(resource) {
+    ;
+}
+
+// Round to nearest even, like the GPU would.
+static uint16_t floatToHalf(float value) {
+    const auto     BITS = std::bit_cast<uint32_t>(value);
+    const uint32_t SIGN = (BITS >> 16) & 0x8000;
+    const int32_t  EXP  = (int32_t)((BITS >> 23) & 0xFF) - 127 + 15;
+    uint32_t       mant = BITS & 0x7FFFFF;
+
+    if (((BITS >> 23) & 0xFF) == 0xFF) // inf and nan
+        return SIGN | 0x7C00 | (mant ? 0x200 : 0);
+
+    if (EXP >= 31)
+        return SIGN | 0x7C00;
+
+    if (EXP <= 0) {
+        if (EXP < -10)
+            return SIGN;
+
+        mant |= 0x800000;
+        const uint32_t SHIFT   = 14 - EXP;
+        const uint32_t REM     = mant & ((1U << SHIFT) - 1);
+        const uint32_t HALFWAY = 1U << (SHIFT - 1);
+        uint32_t       half    = mant >> SHIFT;
+        if (REM > HALFWAY || (REM == HALFWAY && (half & 1)))
+            half++;
+        return SIGN | half;
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent.
+    const uint32_t REM  = mant & 0x1FFF;
+    uint32_t       half = SIGN | ((uint32_t)EXP << 10) | (mant >> 13);
+    if (REM > 0x1000 || (REM == 0x1000 && (half & 1)))
+        half++;
+    return half;
+}
+
+static uint32_t unorm10(float value) {
+    return (uint32_t)std::lround(std::clamp(value, 0.F, 1.F) * 1023.F);
+}
+
+// Cairo stores ARGB32 as native endian words, GL wants bytes in RGBA order.
+static void packRGBA8(SPackedPixels& out, const uint8_t* src, int srcStride, int w, int h, bool opaque) {
+    out.bytesPerPixel  = 4;
+    out.internalFormat = GL_RGBA8;
+    out.format         = GL_RGBA;
+    out.type           = GL_UNSIGNED_BYTE;
+    out.data.resize((size_t)w * h * 4);
+
+    uint8_t* dst = out.data.data();
+    for (int y = 0; y < h; ++y) {
+        const auto* ROW = (const uint32_t*)(src + ((size_t)y * srcStride));
+        for (int x = 0; x < w; ++x) {
+            const uint32_t PX = ROW[x];
+            *dst++            = (PX >> 16) & 0xFF;
+            *dst++            = (PX >> 8) & 0xFF;
+            *dst++            = PX & 0xFF;
+            *dst++            = opaque ? 0xFF : (PX >> 24);
+        }
+    }
+}
+
+// CAIRO_FORMAT_RGB30 is x2r10g10b10 in a native endian word, GL_UNSIGNED_INT_2_10_10_10_REV has red in the low bits.
+static void packRGB30(SPackedPixels& out, const uint8_t* src, int srcStride, int w, int h) {
+    out.bytesPerPixel  = 4;
+    out.internalFormat = GL_RGB10_A2;
+    out.format         = GL_RGBA;
+    out.type           = GL_UNSIGNED_INT_2_10_10_10_REV;
+    out.data.resize((size_t)w * h * 4);
+
+    auto* dst = (uint32_t*)out.data.data();
+    for (int y = 0; y < h; ++y) {
+        const auto* ROW = (const uint32_t*)(src + ((size_t)y * srcStride));
+        for (int x = 0; x < w; ++x) {
+            const uint32_t PX = ROW[x];
+            *dst++            = ((PX >> 20) & 0x3FF) | (PX & 0xFFC00) | ((PX & 0x3FF) << 20) | (3U << 30);
+        }
+    }
+}
+
+// Float surfaces only need half floats if they are translucent or leave [0, 1]. Everything else fits the 10 bit framebuffers.
+static void packFloat(SPackedPixels& out, const uint8_t* src, int srcStride, int w, int h, size_t channels) {
+    bool needsHalf = false;
+    for (int y = 0; y < h && !needsHalf; ++y) {
+        const auto* ROW = (const float*)(src + ((size_t)y * srcStride));
+        for (int x = 0; x < w && !needsHalf; ++x) {
+            const float* px = ROW + ((size_t)x * channels);
+            for (size_t c = 0; c < channels; ++c) {
+                if (px[c] < 0.F || px[c] > 1.F || (c == 3 && px[c] < 1.F)) {
+                    needsHalf = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    out.bytesPerPixel  = needsHalf ? 8 : 4;
+    out.internalFormat = needsHalf ? GL_RGBA16F : GL_RGB10_A2;
+    out.format         = GL_RGBA;
+    out.type           = needsHalf ? GL_HALF_FLOAT : GL_UNSIGNED_INT_2_10_10_10_REV;
+    out.data.resize((size_t)w * h * out.bytesPerPixel);
+
+    auto* halfs = (uint16_t*)out.data.data();
+    auto* words = (uint32_t*)out.data.data();
+    for (int y = 0; y < h; ++y) {
+        const auto* ROW = (const float*)(src + ((size_t)y * srcStride));
+        for (int x = 0; x < w; ++x) {
+            const float* px = ROW + ((size_t)x * channels);
+            const float  A  = channels == 4 ? px[3] : 1.F;
+
+            if (needsHalf) {
+                *halfs++ = floatToHalf(px[0]);
+                *halfs++ = floatToHalf(px[1]);
+                *halfs++ = floatToHalf(px[2]);
+                *halfs++ = floatToHalf(A);
+            } else
+                *words++ = unorm10(px[0]) | (unorm10(px[1]) << 10) | (unorm10(px[2]) << 20) | (3U << 30);
+        }
+    }
+}
+
+static bool packSurface(SPackedPixels& out, cairo_surface_t* surface) {
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        Debug::log(ERR, "Can't pack surface ({})", cairo_status_to_string(cairo_surface_status(surface)));
+        return false;
+    }
+
+    cairo_surface_flush(surface);
+
+    const auto  FORMAT = cairo_image_surface_get_format(surface);
+    const int   W      = cairo_image_surface_get_width(surface);
+    const int   H      = cairo_image_surface_get_height(surface);
+    const int   STRIDE = cairo_image_surface_get_stride(surface);
+    const auto* DATA   = cairo_image_surface_get_data(surface);
+
+    if (W <= 0 || H <= 0 || !DATA)
+        return false;
+
+    switch (FORMAT) {
+        case CAIRO_FORMAT_ARGB32: packRGBA8(out, DATA, STRIDE, W, H, false); return true;
+        case CAIRO_FORMAT_RGB24: packRGBA8(out, DATA, STRIDE, W, H, true); return true;
+        case CAIRO_FORMAT_RGB30: packRGB30(out, DATA, STRIDE, W, H); return true;
+        case CAIRO_FORMAT_RGB96F: packFloat(out, DATA, STRIDE, W, H, 3); return true;
+        case CAIRO_FORMAT_RGBA128F: packFloat(out, DATA, STRIDE, W, H, 4); return true;
+        default: break;
+    }
+
+    // Anything else (A8, RGB16_565, ...) goes through cairo to ARGB32 first.
+    cairo_surface_t* argb = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, W, H);
+    cairo_t*         cr   = cairo_create(argb);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(cr, surface, 0, 0);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(argb);
+
+    const bool OK = cairo_surface_status(argb) == CAIRO_STATUS_SUCCESS;
+    if (OK)
+        packRGBA8(out, cairo_image_surface_get_data(argb), cairo_image_surface_get_stride(argb), W, H, false);
+    else
+        Debug::log(ERR, "Can't convert surface with format {} to ARGB32", (int)FORMAT);
+
+    cairo_surface_destroy(argb);
+    return OK;
+}
+
+void CPackedResource::render() {
+    m_resource->render();
+
+    std::swap(m_asset, m_resource->m_asset);
+    m_resource.reset();
+
+    if (!m_asset.cairoSurface)
+        return;
+
+    cairo_surface_t* surface = m_asset.cairoSurface->cairo();
+
+    m_pixels.emplace();
+    if (!packSurface(*m_pixels, surface))
+        m_pixels->data.clear();
+    else // the upload relies on this matching the packed rows
+        m_asset.pixelSize = {(double)cairo_image_surface_get_width(surface), (double)cairo_image_surface_get_height(surface)};
+
+    m_asset.cairoSurface.reset();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../defines.hpp"
+#include <hyprgraphics/resource/resources/AsyncResource.hpp>
+#include <GLES3/gl32.h>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Tightly packed rows in the layout of the texture they are meant for.
+struct SPackedPixels {
+    std::vector<uint8_t> data;
+    size_t               bytesPerPixel  = 4;
+    GLint                internalFormat = GL_RGBA8;
+    GLenum               format         = GL_RGBA;
+    GLenum               type           = GL_UNSIGNED_BYTE;
+};
+
+// Renders another resource and converts its cairo surface to the smallest of RGBA8, RGB10_A2 and RGBA16F that keeps what gets displayed.
+// Colors stay premultiplied. The surface is dropped afterwards, m_asset only keeps the pixel size.
+class CPackedResource : public Hyprgraphics::IAsyncResource {
+  public:
+    CPackedResource(const ASP<Hyprgraphics::IAsyncResource>& resource);
+    virtual ~CPackedResource() = default;
+
+    virtual void                 render();
+
+    // Empty if the resource didn't produce a surface, no data if the surface was unusable.
+    std::optional<SPackedPixels> m_pixels;
+
+  private:
+    ASP<Hyprgraphics::IAsyncResource> m_resource;
+};
@@ -0,0 +1,120 @@
+#include "SizedImageResource.hpp"
+
+#include "../../defines.hpp"
+#include "../../helpers/Log.hpp"
+#include <hyprgraphics/resource/resources/ImageResource.hpp>
+#include <hyprgraphics/cairo/CairoSurface.hpp>
+#include <algorithm>
+#include <cairo/cairo.h>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+using namespace Hyprgraphics;
+using namespace Hyprutils::Math;
+
+CSizedImageResource::CSizedImageResource(const std::string& path, const Vector2D& targetSize) : m_path(path), m_targetSize(targetSize) {
+    ;
+}
+
+// Averages FACTOR x FACTOR blocks. Works on premultiplied data, so no alpha special-casing is needed.
+template <typename T, size_t CHANNELS>
+static void boxFilter(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, int dstW, int dstH, int factor) {
+    using Acc = std::conditional_t<std::is_integral_v<T>, uint32_t, float>;
+
+    const Acc        AREA = factor * factor;
+    std::vector<Acc> acc((size_t)dstW * CHANNELS);
+
+    for (int y = 0; y < dstH; ++y) {
+        std::ranges::fill(acc, 0);
+
+        for (int sy = y * factor; sy < (y + 1) * factor; ++sy) {
+            const T* row = (const T*)(src + ((size_t)sy * srcStride));
+            for (int x = 0; x < dstW; ++x) {
+                const T* block = row + ((size_t)x * factor * CHANNELS);
+                for (int sx = 0; sx < factor; ++sx) {
+                    for (size_t c = 0; c < CHANNELS; ++c)
+                        acc[(x * CHANNELS) + c] += block[(sx * CHANNELS) + c];
+                }
+            }
+        }
+
+        T* out = (T*)(dst + ((size_t)y * dstStride));
+        for (size_t i = 0; i < acc.size(); ++i) {
+            if constexpr (std::is_integral_v<T>)
+                out[i] = (acc[i] + (AREA / 2)) / AREA;
+            else
+                out[i] = acc[i] / AREA;
+        }
+    }
+}
+
+static cairo_surface_t* downscaleSurface(cairo_surface_t* source, int factor) {
+    const auto FORMAT = cairo_image_surface_get_format(source);
+    const int  DSTW   = cairo_image_surface_get_width(source) / factor;
+    const int  DSTH   = cairo_image_surface_get_height(source) / factor;
+
+    if (DSTW <= 0 || DSTH <= 0)
+        return nullptr;
+
+    cairo_surface_flush(source);
+
+    cairo_surface_t* scaled = cairo_image_surface_create(FORMAT, DSTW, DSTH);
+    if (cairo_surface_status(scaled) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(scaled);
+        return nullptr;
+    }
+
+    const auto* SRC       = cairo_image_surface_get_data(source);
+    const int   SRCSTRIDE = cairo_image_surface_get_stride(source);
+    auto*       dst       = cairo_image_surface_get_data(scaled);
+    const int   DSTSTRIDE = cairo_image_surface_get_stride(scaled);
+
+    switch (FORMAT) {
+        case CAIRO_FORMAT_ARGB32:
+        case CAIRO_FORMAT_RGB24: boxFilter<uint8_t, 4>(SRC, SRCSTRIDE, dst, DSTSTRIDE, DSTW, DSTH, factor); break;
+        case CAIRO_FORMAT_RGB96F: boxFilter<float, 3>(SRC, SRCSTRIDE, dst, DSTSTRIDE, DSTW, DSTH, factor); break;
+        case CAIRO_FORMAT_RGBA128F: boxFilter<float, 4>(SRC, SRCSTRIDE, dst, DSTSTRIDE, DSTW, DSTH, factor); break;
+        default: cairo_surface_destroy(scaled); return nullptr;
+    }
+
+    cairo_surface_mark_dirty(scaled);
+    return scaled;
+}
+
+void CSizedImageResource::render() {
+    Hyprgraphics::CImageResource imageResource(m_path);
+
+    imageResource.render();
+
+    std::swap(m_asset, imageResource.m_asset);
+
+    if (!m_asset.cairoSurface || m_targetSize.x <= 0 || m_targetSize.y <= 0)
+        return;
+
+    cairo_surface_t* surface = m_asset.cairoSurface->cairo();
+    if (!surface || cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+        return;
+
+    const Vector2D SOURCESIZE = {(double)cairo_image_surface_get_width(surface), (double)cairo_image_surface_get_height(surface)};
+    if (SOURCESIZE.x <= 0 || SOURCESIZE.y <= 0)
+        return;
+
+    // Cover-fit, same as the widgets do when drawing. Integer factors keep the filter exact and the result never undershoots the target.
+    const double SCALE  = std::max(m_targetSize.x / SOURCESIZE.x, m_targetSize.y / SOURCESIZE.y);
+    const int    FACTOR = (int)std::floor(1.0 / SCALE);
+    if (FACTOR < 2)
+        return;
+
+    cairo_surface_t* scaled = downscaleSurface(surface, FACTOR);
+    if (!scaled) {
+        Debug::log(WARN, "Failed to downscale {}, keeping it at {}", m_path, SOURCESIZE);
+        return;
+    }
+
+    m_asset.cairoSurface = makeAtomicShared<CCairoSurface>(scaled);
+    m_asset.pixelSize    = Vector2D{(double)cairo_image_surface_get_width(scaled), (double)cairo_image_surface_get_height(scaled)};
+
+    Debug::log(TRACE, "Downscaled {} from {} to {} (target {})", m_path, SOURCESIZE, m_asset.pixelSize, m_targetSize);
+}
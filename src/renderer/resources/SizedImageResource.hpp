@@ -0,0 +1,19 @@
+#pragma once
+
+#include <hyprgraphics/resource/resources/AsyncResource.hpp>
+#include <hyprutils/math/Vector2D.hpp>
+#include <string>
+
+// Decodes an image and box-filters it down on the worker thread, so that the result still covers targetSize.
+// A targetSize of 0x0 keeps the decoded size.
+class CSizedImageResource : public Hyprgraphics::IAsyncResource {
+  public:
+    CSizedImageResource(const std::string& path, const Hyprutils::Math::Vector2D& targetSize);
+    virtual ~CSizedImageResource() = default;
+
+    virtual void render();
+
+  private:
+    std::string               m_path;
+    Hyprutils::Math::Vector2D m_targetSize;
+};
@@ -7,7 +7,7 @@
 
 using namespace Hyprgraphics;
 
-CTextCmdResource::CTextCmdResource(CTextResource::STextResourceData&& data) : m_data(std::move(data)) {
+CTextCmdResource::CTextCmdResource(CTextResource::STextResourceData&& data, const ASP<STextCmdOutput>& lastOutput) : m_data(std::move(data)), m_lastOutput(lastOutput) {
     ;
 }
 
@@ -23,9 +23,20 @@ void CTextCmdResource::render() {
         textData.text.erase(textData.text.find_last_not_of(" \n\r\t") + 1);
     }
 
+    if (m_lastOutput && m_lastOutput->shown == textData.text)
+        return;
+
+    const auto                  TEXT = m_lastOutput ? textData.text : std::string{};
+
     Hyprgraphics::CTextResource textResource(std::move(textData));
 
     textResource.render();
 
     std::swap(m_asset, textResource.m_asset);
+
+    // Only output that made it into a surface counts, a failed render has to be retried with the same text.
+    if (m_lastOutput && m_asset.cairoSurface) {
+        std::lock_guard<std::mutex> lg(m_lastOutput->mutex);
+        m_lastOutput->rendered = TEXT;
+    }
 }
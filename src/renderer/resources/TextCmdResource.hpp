@@ -1,15 +1,31 @@
 #pragma once
 
+#include "../../defines.hpp"
 #include <hyprgraphics/resource/resources/AsyncResource.hpp>
 #include <hyprgraphics/resource/resources/TextResource.hpp>
+#include <mutex>
+#include <optional>
+#include <string>
+
+// One run of a cmd label. The widget fills in what it shows before the request,
+// the worker what it rasterised. The widget only takes that over once it got the texture.
+struct STextCmdOutput {
+    // Read-only after the request.
+    std::optional<std::string> shown;
+
+    std::mutex                 mutex;
+    std::optional<std::string> rendered;
+};
 
 class CTextCmdResource : public Hyprgraphics::IAsyncResource {
   public:
-    CTextCmdResource(Hyprgraphics::CTextResource::STextResourceData&& data);
+    // If the command prints what lastOutput->shown already is, nothing gets rendered and the resource ends up without a surface.
+    CTextCmdResource(Hyprgraphics::CTextResource::STextResourceData&& data, const ASP<STextCmdOutput>& lastOutput);
     virtual ~CTextCmdResource() = default;
 
     virtual void render();
 
   private:
     Hyprgraphics::CTextResource::STextResourceData m_data;
+    ASP<STextCmdOutput>                            m_lastOutput;
 };
@@ -2,6 +2,7 @@
 #include "../Renderer.hpp"
 #include "../AsyncResourceManager.hpp"
 #include "../Framebuffer.hpp"
+#include "../GPUWorker.hpp"
 #include "../../core/hyprlock.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../helpers/MiscFunctions.hpp"
@@ -13,8 +14,8 @@
 #include <GLES3/gl32.h>
 
 CBackground::CBackground() {
-    blurredFB        = makeUnique<CFramebuffer>();
-    pendingBlurredFB = makeUnique<CFramebuffer>();
+    blurredFB        = makeAtomicShared<CFramebuffer>();
+    pendingBlurredFB = makeAtomicShared<CFramebuffer>();
     transformedScFB  = makeUnique<CFramebuffer>();
 }
 
@@ -50,27 +51,26 @@ void CBackground::configure(const std::unordered_map<std::string, std::any>& pro
 
     isScreenshot = path == "screenshot";
 
-    viewport     = pOutput->getViewport();
-    outputPort   = pOutput->stringPort;
-    transform    = wlTransformToHyprutils(invertTransform(pOutput->transform));
-    scResourceID = CAsyncResourceManager::resourceIDForScreencopy(pOutput->stringPort);
+    viewport          = pOutput->getViewport();
+    m_imageTargetSize = pOutput->size; // matches what enqueueStaticAssets preloads
+    outputPort        = pOutput->stringPort;
+    transform         = wlTransformToHyprutils(invertTransform(pOutput->transform));
+    scResource        = g_asyncResourceManager->acquire(CAsyncResourceManager::resourceIDForScreencopy(pOutput->stringPort));
 
     g_pAnimationManager->createAnimation(0.f, crossFadeProgress, g_pConfigManager->m_AnimationTree.getConfig("fadeIn"));
 
-    if (!g_asyncResourceManager->checkIdPresent(scResourceID)) {
+    if (!scResource)
         Debug::log(LOG, "Missing screenshot for output {}", outputPort);
-        scResourceID = 0;
-    }
 
     if (isScreenshot) {
-        resourceID = scResourceID; // Fallback to solid background:color when scResourceID==0
+        resource = g_asyncResourceManager->acquire(scResource.id()); // Fallback to solid background:color without a screenshot
 
-        if (!g_pHyprlock->getScreencopy()) {
+        if (!g_pHyprlock->canScreencopy()) {
             Debug::log(ERR, "No screencopy support! path=screenshot won't work. Falling back to background color.");
-            resourceID = 0;
+            resource.reset();
         }
     } else if (!path.empty())
-        resourceID = g_asyncResourceManager->requestImage(path, m_imageRevision, nullptr);
+        resource = g_asyncResourceManager->requestImage(path, m_imageRevision, m_imageTargetSize, nullptr, RESOURCE_PRIORITY_BACKGROUND);
 
     if (!reloadCommand.empty() && reloadTime > -1) {
         try {
@@ -88,37 +88,41 @@ void CBackground::reset() {
         reloadTimer.reset();
     }
 
+    reloadPaused = false;
+
     blurredFB->destroyBuffer();
     pendingBlurredFB->destroyBuffer();
 }
 
 void CBackground::updatePrimaryAsset() {
-    if (asset || resourceID == 0)
+    if (asset || !resource)
         return;
 
-    asset = g_asyncResourceManager->getAssetByID(resourceID);
+    asset = resource.texture();
     if (!asset)
         return;
 
     const bool NEEDFB = (isScreenshot || blurPasses > 0 || asset->m_vSize != viewport || transform != HYPRUTILS_TRANSFORM_NORMAL) && (!blurredFB->isAllocated() || firstRender);
-    if (NEEDFB)
-        renderToFB(*asset, *blurredFB, blurPasses, isScreenshot);
-}
-
-void CBackground::updatePendingAsset() {
-    // For crossfading a new asset
-    if (!pendingAsset || blurPasses == 0 || pendingBlurredFB->isAllocated())
+    if (!NEEDFB)
         return;
 
-    renderToFB(*pendingAsset, *pendingBlurredFB, blurPasses);
+    // Until the bake is done, draw behaves as if the asset was not ready yet.
+    m_primaryBakePending = true;
+    bakeToFB(asset, blurPasses, isScreenshot, [REF = m_self](ASP<CFramebuffer> fb) {
+        if (const auto PSELF = REF.lock()) {
+            PSELF->blurredFB->destroyBuffer();
+            PSELF->blurredFB            = fb;
+            PSELF->m_primaryBakePending = false;
+        }
+    });
 }
 
 void CBackground::updateScAsset() {
-    if (scAsset || scResourceID == 0)
+    if (scAsset || !scResource)
         return;
 
     // path=screenshot -> scAsset = asset
-    scAsset = (asset && isScreenshot) ? asset : g_asyncResourceManager->getAssetByID(scResourceID);
+    scAsset = (asset && isScreenshot) ? asset : scResource.texture();
     if (!scAsset)
         return;
 
@@ -173,13 +177,12 @@ static CBox getScaledBoxForTextureSize(const Vector2D& size, const Vector2D& vie
     return texbox;
 }
 
-void CBackground::renderToFB(const CTexture& tex, CFramebuffer& fb, int passes, bool applyTransform) {
-    if (firstRender)
-        firstRender = false;
-
+// Does not touch widget state, so that the gpu worker can call it.
+static void renderTextureToFB(CRenderer& renderer, const CTexture& tex, CFramebuffer& fb, const Vector2D& viewport, eTransform transform,
+                              const std::optional<CRenderer::SBlurParams>& blur) {
     // make it brah
     Vector2D size = tex.m_vSize;
-    if (applyTransform && transform % 2 == 1) {
+    if (transform % 2 == 1) {
         size.x = tex.m_vSize.y;
         size.y = tex.m_vSize.x;
     }
@@ -191,35 +194,80 @@ void CBackground::renderToFB(const CTexture& tex, CFramebuffer& fb, int passes,
 
     fb.bind();
 
-    g_pRenderer->renderTexture(TEXBOX, tex, 1.0, 0, applyTransform ? transform : HYPRUTILS_TRANSFORM_NORMAL);
-
-    if (blurPasses > 0)
-        g_pRenderer->blurFB(fb,
-                            CRenderer::SBlurParams{
-                                .size              = blurSize,
-                                .passes            = passes,
-                                .noise             = noise,
-                                .contrast          = contrast,
-                                .brightness        = brightness,
-                                .vibrancy          = vibrancy,
-                                .vibrancy_darkness = vibrancy_darkness,
-                            });
+    renderer.renderTexture(TEXBOX, tex, 1.0, 0, transform);
+
+    if (blur)
+        renderer.blurFB(fb, *blur);
+
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 }
 
+std::optional<CRenderer::SBlurParams> CBackground::getBlurParams(int passes) const {
+    if (blurPasses <= 0)
+        return std::nullopt;
+
+    return CRenderer::SBlurParams{
+        .size              = blurSize,
+        .passes            = passes,
+        .noise             = noise,
+        .contrast          = contrast,
+        .brightness        = brightness,
+        .vibrancy          = vibrancy,
+        .vibrancy_darkness = vibrancy_darkness,
+    };
+}
+
+void CBackground::renderToFB(const CTexture& tex, CFramebuffer& fb, int passes, bool applyTransform) {
+    if (firstRender)
+        firstRender = false;
+
+    renderTextureToFB(*g_pRenderer, tex, fb, viewport, applyTransform ? transform : HYPRUTILS_TRANSFORM_NORMAL, getBlurParams(passes));
+}
+
+void CBackground::bakeToFB(ASP<CTexture> tex, int passes, bool applyTransform, std::function<void(ASP<CFramebuffer>)>&& onBaked) {
+    auto fb = makeAtomicShared<CFramebuffer>();
+
+    if (!g_pGPUWorker || !g_pGPUWorker->ok()) {
+        // Might be called outside of renderLock
+        g_pRenderer->setOffscreenProjection(viewport);
+        renderToFB(*tex, *fb, passes, applyTransform);
+        onBaked(fb);
+        return;
+    }
+
+    if (firstRender)
+        firstRender = false;
+
+    // Everything the bake needs is copied, the worker must not access the widget.
+    g_pGPUWorker->enqueue(
+        [tex, fb, VIEWPORT = viewport, TRANSFORM = applyTransform ? transform : HYPRUTILS_TRANSFORM_NORMAL, BLUR = getBlurParams(passes)](CRenderer& renderer) {
+            renderer.setOffscreenProjection(VIEWPORT);
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+            renderTextureToFB(renderer, *tex, *fb, VIEWPORT, TRANSFORM, BLUR);
+
+            glDisable(GL_BLEND);
+            fb->releaseFramebufferObject();
+        },
+        [fb, onBaked = std::move(onBaked), PORT = outputPort]() {
+            onBaked(fb);
+            g_pHyprlock->renderOutput(PORT);
+        });
+}
+
 bool CBackground::draw(const SRenderData& data) {
     updatePrimaryAsset();
-    updatePendingAsset();
     updateScAsset();
 
     if (asset && asset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(asset);
-        resourceID = 0;
+        resource.reset();
         renderRect(color);
         return false;
     }
 
-    if (!asset || resourceID == 0) {
+    if (!asset || !resource || m_primaryBakePending) {
         // fade in/out with a solid color
         if (data.opacity < 1.0 && scAsset) {
             const auto& SCTEX    = getScAssetTex();
@@ -232,7 +280,7 @@ bool CBackground::draw(const SRenderData& data) {
         }
 
         renderRect(color);
-        return !asset && resourceID > 0; // resource not ready
+        return !asset && resource; // resource not ready
     }
 
     const auto& TEX    = getPrimaryAssetTex();
@@ -250,39 +298,58 @@ bool CBackground::draw(const SRenderData& data) {
 }
 
 void CBackground::onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) {
-    pendingResource = false;
+    if (!pendingResource || pendingResource.id() != id) // outdated
+        return;
+
+    auto handle = std::move(pendingResource);
 
     if (!newAsset)
         Debug::log(ERR, "Background asset update failed, resourceID: {} not available on update!", id);
-    else if (newAsset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(newAsset);
+    else if (newAsset->m_iType == TEXTURE_INVALID)
         Debug::log(ERR, "New background asset has an invalid texture!");
-    } else {
-        pendingAsset = newAsset;
-        crossFadeProgress->setValueAndWarp(0);
-        *crossFadeProgress = 1.0;
-
-        crossFadeProgress->setCallbackOnEnd(
-            [REF = m_self, id](auto) {
-                if (const auto PSELF = REF.lock()) {
-                    if (PSELF->asset)
-                        g_asyncResourceManager->unload(PSELF->asset);
-                    PSELF->asset        = PSELF->pendingAsset;
-                    PSELF->pendingAsset = nullptr;
-                    PSELF->resourceID   = id;
-
-                    PSELF->blurredFB->destroyBuffer();
-                    PSELF->blurredFB = std::move(PSELF->pendingBlurredFB);
-                }
-            },
-            true);
+    else {
+        pendingAsset         = newAsset;
+        pendingAssetResource = std::move(handle);
+
+        if (blurPasses == 0) {
+            startCrossFade();
+            return;
+        }
+
+        // Crossfade once the new asset is blurred
+        bakeToFB(pendingAsset, blurPasses, false, [REF = m_self](ASP<CFramebuffer> fb) {
+            if (const auto PSELF = REF.lock()) {
+                PSELF->pendingBlurredFB->destroyBuffer();
+                PSELF->pendingBlurredFB = fb;
+                PSELF->startCrossFade();
+            }
+        });
     }
 }
 
+void CBackground::startCrossFade() {
+    crossFadeProgress->setValueAndWarp(0);
+    *crossFadeProgress = 1.0;
+
+    crossFadeProgress->setCallbackOnEnd(
+        [REF = m_self](auto) {
+            if (const auto PSELF = REF.lock()) {
+                PSELF->asset        = PSELF->pendingAsset;
+                PSELF->pendingAsset = nullptr;
+                PSELF->resource     = std::move(PSELF->pendingAssetResource);
+
+                PSELF->blurredFB->destroyBuffer();
+                PSELF->blurredFB        = std::move(PSELF->pendingBlurredFB);
+                PSELF->pendingBlurredFB = makeAtomicShared<CFramebuffer>();
+            }
+        },
+        true);
+}
+
 void CBackground::plantReloadTimer() {
 
     if (reloadTime == 0)
-        reloadTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onReloadTimer(REF); }, nullptr, true);
+        reloadTimer = g_pHyprlock->addTimer(TIMER_NO_DEADLINE, [REF = m_self](auto, auto) { onReloadTimer(REF); }, nullptr, true);
     else if (reloadTime > 0)
         reloadTimer = g_pHyprlock->addTimer(std::chrono::seconds(reloadTime), [REF = m_self](auto, auto) { onReloadTimer(REF); }, nullptr, true);
 }
@@ -324,9 +391,24 @@ void CBackground::onReloadTimerUpdate() {
     if (pendingResource)
         return;
 
-    pendingResource = true;
-
     // Issue the next request
     AWP<IWidget> widget(m_self);
-    g_asyncResourceManager->requestImage(path, m_imageRevision, widget);
+    pendingResource = g_asyncResourceManager->requestImage(path, m_imageRevision, m_imageTargetSize, widget, RESOURCE_PRIORITY_BACKGROUND);
+}
+
+void CBackground::onSuspend() {
+    if (reloadTimer && reloadTimer->hasDeadline()) {
+        reloadTimer->cancel();
+        reloadTimer.reset();
+        reloadPaused = true;
+    }
+}
+
+void CBackground::onResume() {
+    if (!reloadPaused)
+        return;
+
+    reloadPaused = false;
+    onReloadTimerUpdate();
+    plantReloadTimer();
 }
@@ -6,11 +6,15 @@
 #include "../../helpers/Color.hpp"
 #include "../../core/Timer.hpp"
 #include "../Framebuffer.hpp"
+#include "../Renderer.hpp"
+#include "../ResourceHandle.hpp"
 #include <hyprutils/math/Misc.hpp>
 #include <string>
 #include <unordered_map>
 #include <any>
 #include <filesystem>
+#include <functional>
+#include <optional>
 
 struct SPreloadedAsset;
 class COutput;
@@ -25,11 +29,13 @@ class CBackground : public IWidget {
     virtual void    configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput);
     virtual bool    draw(const SRenderData& data);
     virtual void    onAssetUpdate(ResourceID id, ASP<CTexture> newAsset);
+    // Only pauses the reload timer. The baked background is what the output shows first when it comes back on.
+    virtual void    onSuspend();
+    virtual void    onResume();
 
     void            reset(); // Unload assets, remove timers, etc.
 
     void            updatePrimaryAsset();
-    void            updatePendingAsset();
     void            updateScAsset();
 
     const CTexture& getPrimaryAssetTex() const;
@@ -38,18 +44,23 @@ class CBackground : public IWidget {
 
     void            renderRect(CHyprColor color);
     void            renderToFB(const CTexture& text, CFramebuffer& fb, int passes, bool applyTransform = false);
+    // Same as renderToFB, but on the gpu worker when available. onBaked runs on the main thread.
+    void            bakeToFB(ASP<CTexture> tex, int passes, bool applyTransform, std::function<void(ASP<CFramebuffer>)>&& onBaked);
 
     void            onReloadTimerUpdate();
     void            plantReloadTimer();
     void            startCrossFade();
 
   private:
-    AWP<CBackground> m_self;
+    std::optional<CRenderer::SBlurParams> getBlurParams(int passes) const;
+
+    AWP<CBackground>                      m_self;
 
     // if needed
-    UP<CFramebuffer>                blurredFB;
-    UP<CFramebuffer>                pendingBlurredFB;
+    ASP<CFramebuffer>               blurredFB;
+    ASP<CFramebuffer>               pendingBlurredFB;
     UP<CFramebuffer>                transformedScFB;
+    bool                            m_primaryBakePending = false;
 
     int                             blurSize          = 10;
     int                             blurPasses        = 3;
@@ -64,9 +75,10 @@ class CBackground : public IWidget {
     std::string                     outputPort;
     Hyprutils::Math::eTransform     transform;
 
-    ResourceID                      resourceID      = 0;
-    ResourceID                      scResourceID    = 0;
-    bool                            pendingResource = false;
+    CResourceHandle                 resource;
+    CResourceHandle                 scResource;
+    CResourceHandle                 pendingResource;      // reload in flight
+    CResourceHandle                 pendingAssetResource; // keeps pendingAsset loaded until the cross fade is done
 
     PHLANIMVAR<float>               crossFadeProgress;
 
@@ -80,6 +92,8 @@ class CBackground : public IWidget {
     int                             reloadTime = -1;
     std::string                     reloadCommand;
     ASP<CTimer>                     reloadTimer;
+    bool                            reloadPaused = false;
     std::filesystem::file_time_type modificationTime;
     size_t                          m_imageRevision = 0;
+    Vector2D                        m_imageTargetSize;
 };
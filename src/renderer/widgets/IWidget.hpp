@@ -36,6 +36,10 @@ class IWidget {
     };
     virtual void onClick(uint32_t button, bool down, const Vector2D& pos) {}
     virtual void onHover(const Vector2D& pos) {}
+    // The output got powered off. Pause timers and free framebuffers that draw() can regenerate.
+    virtual void onSuspend() {}
+    // The output is on again. Catch up on what was paused.
+    virtual void onResume() {}
     bool         containsPoint(const Vector2D& pos) const;
 
     struct SFormatResult {
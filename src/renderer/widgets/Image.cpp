@@ -61,16 +61,14 @@ void CImage::onTimerUpdate() {
         return;
     }
 
-    m_pendingResource = true;
-
     AWP<IWidget> widget(m_self);
-    g_asyncResourceManager->requestImage(path, m_imageRevision, widget);
+    m_pendingResource = g_asyncResourceManager->requestImage(path, m_imageRevision, m_imageTargetSize, widget, RESOURCE_PRIORITY_STATIC);
 }
 
 void CImage::plantTimer() {
 
     if (reloadTime == 0) {
-        imageTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onTimer(REF); }, nullptr, true);
+        imageTimer = g_pHyprlock->addTimer(TIMER_NO_DEADLINE, [REF = m_self](auto, auto) { onTimer(REF); }, nullptr, true);
     } else if (reloadTime > 0)
         imageTimer = g_pHyprlock->addTimer(std::chrono::seconds(reloadTime), [REF = m_self](auto, auto) { onTimer(REF); }, nullptr, false);
 }
@@ -103,8 +101,9 @@ void CImage::configure(const std::unordered_map<std::string, std::any>& props, c
         RASSERT(false, "Missing propperty for CImage: {}", e.what()); //
     }
 
-    resourceID = g_asyncResourceManager->requestImage(path, m_imageRevision, nullptr);
-    angle      = angle * M_PI / 180.0;
+    m_imageTargetSize = Vector2D{(double)size, (double)size};
+    resource          = g_asyncResourceManager->requestImage(path, m_imageRevision, m_imageTargetSize, nullptr, RESOURCE_PRIORITY_STATIC);
+    angle             = angle * M_PI / 180.0;
 
     if (reloadTime > -1) {
         try {
@@ -121,33 +120,32 @@ void CImage::reset() {
         imageTimer.reset();
     }
 
+    timerPaused = false;
+
     if (g_pHyprlock->m_bTerminate)
         return;
 
     imageFB.destroyBuffer();
 
-    if (asset && reloadTime > -1) // Don't unload asset if it's a static image
-        g_asyncResourceManager->unload(asset);
-
-    asset             = nullptr;
-    m_pendingResource = false;
-    resourceID        = 0;
+    asset = nullptr;
+    resource.reset();
+    m_pendingResource.reset();
 }
 
 bool CImage::draw(const SRenderData& data) {
 
-    if (resourceID == 0)
+    if (!resource)
         return false;
 
     if (!asset)
-        asset = g_asyncResourceManager->getAssetByID(resourceID);
+        asset = resource.texture();
 
     if (!asset)
         return true;
 
     if (asset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(asset);
-        resourceID = 0;
+        asset = nullptr;
+        resource.reset();
         return false;
     }
 
@@ -210,19 +208,20 @@ bool CImage::draw(const SRenderData& data) {
 }
 
 void CImage::onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) {
-    m_pendingResource = false;
+    if (!m_pendingResource || m_pendingResource.id() != id) // outdated
+        return;
+
+    auto handle = std::move(m_pendingResource);
 
     if (!newAsset)
         Debug::log(ERR, "asset update failed, resourceID: {} not available on update!", id);
-    else if (newAsset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(newAsset);
+    else if (newAsset->m_iType == TEXTURE_INVALID)
         Debug::log(ERR, "New image asset has an invalid texture!");
-    } else {
-        g_asyncResourceManager->unload(asset);
+    else {
         imageFB.destroyBuffer();
 
         asset       = newAsset;
-        resourceID  = id;
+        resource    = std::move(handle);
         firstRender = true;
     }
 }
@@ -246,3 +245,24 @@ void CImage::onHover(const Vector2D& pos) {
     if (!onclickCommand.empty())
         g_pSeatManager->m_pCursorShape->setShape(WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_POINTER);
 }
+
+void CImage::onSuspend() {
+    if (imageTimer && imageTimer->hasDeadline()) {
+        imageTimer->cancel();
+        imageTimer.reset();
+        timerPaused = true;
+    }
+
+    imageFB.destroyBuffer();
+    shadow.release();
+    firstRender = true;
+}
+
+void CImage::onResume() {
+    if (!timerPaused)
+        return;
+
+    timerPaused = false;
+    onTimerUpdate();
+    plantTimer();
+}
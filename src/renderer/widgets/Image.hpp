@@ -6,6 +6,7 @@
 #include "../../helpers/Math.hpp"
 #include "../../config/ConfigDataValues.hpp"
 #include "../../core/Timer.hpp"
+#include "../ResourceHandle.hpp"
 #include "Shadowable.hpp"
 #include <string>
 #include <filesystem>
@@ -29,6 +30,8 @@ class CImage : public IWidget {
     virtual CBox getBoundingBoxWl() const;
     virtual void onClick(uint32_t button, bool down, const Vector2D& pos);
     virtual void onHover(const Vector2D& pos);
+    virtual void onSuspend();
+    virtual void onResume();
 
     void         reset();
 
@@ -59,14 +62,16 @@ class CImage : public IWidget {
 
     std::filesystem::file_time_type modificationTime;
     size_t                          m_imageRevision = 0;
+    Vector2D                        m_imageTargetSize;
 
     ASP<CTimer>                     imageTimer;
+    bool                            timerPaused = false;
 
     Vector2D                        viewport;
     std::string                     stringPort;
 
-    ResourceID                      resourceID        = 0;
-    bool                            m_pendingResource = false;
+    CResourceHandle                 resource;
+    CResourceHandle                 m_pendingResource;
 
     ASP<CTexture>                   asset = nullptr;
     CShadowable                     shadow;
@@ -28,7 +28,11 @@ static void onTimer(AWP<CLabel> ref) {
 }
 
 void CLabel::onTimerUpdate() {
-    if (m_pendingResource) {
+    AWP<IWidget> widget(m_self);
+
+    // A request that didn't start rendering yet is outdated now, replace it. One that is rendering gets to finish.
+    const bool SUPERSEDE = (bool)m_pendingResource;
+    if (SUPERSEDE && !g_asyncResourceManager->cancelRequest(m_pendingResource, widget)) {
         Debug::log(WARN, "Trying to update label, but a resource is still pending! Skipping update.");
         return;
     }
@@ -37,20 +41,19 @@ void CLabel::onTimerUpdate() {
 
     label = formatString(labelPreFormat);
 
-    if (label.formatted == oldFormatted && !label.alwaysUpdate)
+    if (label.formatted == oldFormatted && !label.alwaysUpdate && !SUPERSEDE)
         return;
 
     // request new
-    request.text      = label.formatted;
-    m_pendingResource = true;
+    request.text = label.formatted;
 
-    AWP<IWidget> widget(m_self);
     if (label.cmd) {
         // Don't increment by one to avoid clashes with multiple widget using the same label command.
         m_dynamicRevision += label.updateEveryMs;
-        g_asyncResourceManager->requestTextCmd(request, m_dynamicRevision, widget.lock());
+        m_pendingCmdOutput = makeCmdOutput();
+        m_pendingResource  = g_asyncResourceManager->requestTextCmd(request, m_dynamicRevision, widget, m_pendingCmdOutput);
     } else
-        g_asyncResourceManager->requestText(request, widget.lock());
+        m_pendingResource = g_asyncResourceManager->requestText(request, widget, RESOURCE_PRIORITY_STATIC);
 }
 
 void CLabel::plantTimer() {
@@ -58,7 +61,7 @@ void CLabel::plantTimer() {
     if (label.updateEveryMs != 0)
         labelTimer = g_pHyprlock->addTimer(std::chrono::milliseconds((int)label.updateEveryMs), [REF = m_self](auto, auto) { onTimer(REF); }, this, label.allowForceUpdate);
     else if (label.updateEveryMs == 0 && label.allowForceUpdate)
-        labelTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onTimer(REF); }, this, true);
+        labelTimer = g_pHyprlock->addTimer(TIMER_NO_DEADLINE, [REF = m_self](auto, auto) { onTimer(REF); }, this, true);
 }
 
 void CLabel::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
@@ -102,9 +105,10 @@ void CLabel::configure(const std::unordered_map<std::string, std::any>& props, c
     pos = configPos; // Label size not known yet
 
     if (label.cmd) {
-        resourceID = g_asyncResourceManager->requestTextCmd(request, m_dynamicRevision, nullptr);
+        m_cmdOutput = makeCmdOutput();
+        resource    = g_asyncResourceManager->requestTextCmd(request, m_dynamicRevision, nullptr, m_cmdOutput);
     } else
-        resourceID = g_asyncResourceManager->requestText(request, nullptr);
+        resource = g_asyncResourceManager->requestText(request, nullptr, RESOURCE_PRIORITY_STATIC);
 
     plantTimer();
 }
@@ -115,23 +119,27 @@ void CLabel::reset() {
         labelTimer.reset();
     }
 
+    timerPaused = false;
+
     if (g_pHyprlock->m_bTerminate)
         return;
 
-    if (asset)
-        g_asyncResourceManager->unload(asset);
-
-    asset             = nullptr;
-    m_pendingResource = false;
-    resourceID        = 0;
+    asset = nullptr;
+    resource.reset();
+    m_pendingResource.reset();
+    m_cmdShown.reset();
+    m_cmdOutput.reset();
+    m_pendingCmdOutput.reset();
 }
 
 bool CLabel::draw(const SRenderData& data) {
     if (!asset) {
-        asset = g_asyncResourceManager->getAssetByID(resourceID);
+        asset = resource.texture();
 
         if (!asset)
             return true;
+
+        commitCmdOutput(m_cmdOutput);
     }
 
     if (updateShadow) {
@@ -153,22 +161,46 @@ bool CLabel::draw(const SRenderData& data) {
 
 void CLabel::onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) {
     Debug::log(TRACE, "Label update for resourceID {}", id);
-    m_pendingResource = false;
 
-    if (!newAsset)
+    if (!m_pendingResource || m_pendingResource.id() != id) // outdated
+        return;
+
+    auto handle    = std::move(m_pendingResource);
+    auto cmdOutput = std::move(m_pendingCmdOutput);
+
+    if (!newAsset && label.cmd)
+        Debug::log(TRACE, "Label cmd output unchanged, keeping resourceID: {}", resource.id());
+    else if (!newAsset)
         Debug::log(ERR, "asset update failed, resourceID: {} not available on update!", id);
-    else if (newAsset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(newAsset);
+    else if (newAsset->m_iType == TEXTURE_INVALID)
         Debug::log(ERR, "New image asset has an invalid texture!");
-    } else {
+    else {
         // new asset is ready :D
-        g_asyncResourceManager->unload(asset);
+        // Drop the old texture before its handle, so it can be recycled.
         asset        = newAsset;
-        resourceID   = id;
+        resource     = std::move(handle);
+        m_cmdOutput  = std::move(cmdOutput);
         updateShadow = true;
+
+        commitCmdOutput(m_cmdOutput);
     }
 }
 
+ASP<STextCmdOutput> CLabel::makeCmdOutput() const {
+    auto output   = makeAtomicShared<STextCmdOutput>();
+    output->shown = m_cmdShown;
+    return output;
+}
+
+void CLabel::commitCmdOutput(const ASP<STextCmdOutput>& output) {
+    if (!output)
+        return;
+
+    std::lock_guard<std::mutex> lg(output->mutex);
+    if (output->rendered)
+        m_cmdShown = output->rendered;
+}
+
 CBox CLabel::getBoundingBoxWl() const {
     if (!asset)
         return CBox{};
@@ -188,3 +220,24 @@ void CLabel::onHover(const Vector2D& pos) {
     if (!onclickCommand.empty())
         g_pSeatManager->m_pCursorShape->setShape(WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_POINTER);
 }
+
+void CLabel::onSuspend() {
+    // Timers without a deadline don't cost anything, keep them for force updates.
+    if (labelTimer && labelTimer->hasDeadline()) {
+        labelTimer->cancel();
+        labelTimer.reset();
+        timerPaused = true;
+    }
+
+    shadow.release();
+    updateShadow = true;
+}
+
+void CLabel::onResume() {
+    if (!timerPaused)
+        return;
+
+    timerPaused = false;
+    onTimerUpdate();
+    plantTimer();
+}
@@ -4,8 +4,11 @@
 #include "IWidget.hpp"
 #include "Shadowable.hpp"
 #include "../../core/Timer.hpp"
+#include "../ResourceHandle.hpp"
+#include "../resources/TextCmdResource.hpp"
 #include <hyprgraphics/resource/resources/AsyncResource.hpp>
 #include <hyprgraphics/resource/resources/TextResource.hpp>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <any>
@@ -27,6 +30,8 @@ class CLabel : public IWidget {
     virtual CBox getBoundingBoxWl() const;
     virtual void onClick(uint32_t button, bool down, const Vector2D& pos);
     virtual void onHover(const Vector2D& pos);
+    virtual void onSuspend();
+    virtual void onResume();
 
     void         reset();
 
@@ -48,10 +53,18 @@ class CLabel : public IWidget {
     Vector2D                                       configPos;
     double                                         angle;
 
-    ResourceID                                     resourceID        = 0;
-    bool                                           m_pendingResource = false;
+    CResourceHandle                                resource;
+    CResourceHandle                                m_pendingResource;
 
     size_t                                         m_dynamicRevision = 0;
+    // What the current texture shows, and the runs behind resource and m_pendingResource.
+    std::optional<std::string>                     m_cmdShown;
+    ASP<STextCmdOutput>                            m_cmdOutput;
+    ASP<STextCmdOutput>                            m_pendingCmdOutput;
+    // For the next cmd request.
+    ASP<STextCmdOutput>                            makeCmdOutput() const;
+    // Remembers what output shows, if its run rendered anything.
+    void                                           commitCmdOutput(const ASP<STextCmdOutput>& output);
 
     ASP<CTexture>                                  asset = nullptr;
 
@@ -59,7 +72,8 @@ class CLabel : public IWidget {
 
     Hyprgraphics::CTextResource::STextResourceData request;
 
-    ASP<CTimer>                                    labelTimer = nullptr;
+    ASP<CTimer>                                    labelTimer  = nullptr;
+    bool                                           timerPaused = false;
 
     CShadowable                                    shadow;
     bool                                           updateShadow = true;
@@ -89,11 +89,11 @@ void CPasswordInputField::configure(const std::unordered_map<std::string, std::a
 
     if (!dots.textFormat.empty()) {
         Hyprgraphics::CTextResource::STextResourceData request;
-        request.text        = dots.textFormat;
-        request.font        = fontFamily;
-        request.color       = colorConfig.font.asRGB();
-        request.fontSize    = (int)(std::nearbyint(configSize.y * dots.size * 0.5f) * 2.f);
-        dots.textResourceID = g_asyncResourceManager->requestText(request, nullptr);
+        request.text      = dots.textFormat;
+        request.font      = fontFamily;
+        request.color     = colorConfig.font.asRGB();
+        request.fontSize  = (int)(std::nearbyint(configSize.y * dots.size * 0.5f) * 2.f);
+        dots.textResource = g_asyncResourceManager->requestText(request, nullptr, RESOURCE_PRIORITY_INPUT_FIELD);
     }
 
     // request the inital placeholder asset
@@ -109,11 +109,8 @@ void CPasswordInputField::reset() {
     if (g_pHyprlock->m_bTerminate)
         return;
 
-    if (placeholder.asset)
-        g_asyncResourceManager->unload(placeholder.asset);
-
-    placeholder.asset      = nullptr;
-    placeholder.resourceID = 0;
+    placeholder.asset = nullptr;
+    placeholder.resource.reset();
     placeholder.currentText.clear();
 }
 
@@ -240,7 +237,7 @@ bool CPasswordInputField::draw(const SRenderData& data) {
 
         if (!dots.textFormat.empty()) {
             if (!dots.textAsset)
-                dots.textAsset = g_asyncResourceManager->getAssetByID(dots.textResourceID);
+                dots.textAsset = dots.textResource.texture();
 
             if (!dots.textAsset)
                 forceReload = true;
@@ -299,11 +296,11 @@ bool CPasswordInputField::draw(const SRenderData& data) {
         }
     }
 
-    if (passwordLength == 0 && !checkWaiting && placeholder.resourceID > 0) {
+    if (passwordLength == 0 && !checkWaiting && placeholder.resource) {
         ASP<CTexture> currAsset = nullptr;
 
         if (!placeholder.asset)
-            placeholder.asset = g_asyncResourceManager->getAssetByID(placeholder.resourceID);
+            placeholder.asset = placeholder.resource.texture();
 
         currAsset = placeholder.asset;
 
@@ -327,10 +324,9 @@ bool CPasswordInputField::draw(const SRenderData& data) {
 void CPasswordInputField::updatePlaceholder() {
     if (passwordLength != 0) {
         if (placeholder.asset && /* keep prompt asset cause it is likely to be used again */ displayFail) {
-            g_asyncResourceManager->unload(placeholder.asset);
-            placeholder.asset      = nullptr;
-            placeholder.resourceID = 0;
-            redrawShadow           = true;
+            placeholder.asset = nullptr;
+            placeholder.resource.reset();
+            redrawShadow = true;
         }
         return;
     }
@@ -360,7 +356,7 @@ void CPasswordInputField::updatePlaceholder() {
     request.fontSize = (int)size->value().y / 4;
 
     AWP<IWidget> widget(m_self);
-    placeholder.resourceID = g_asyncResourceManager->requestText(request, widget);
+    placeholder.resource = g_asyncResourceManager->requestText(request, widget, RESOURCE_PRIORITY_INPUT_FIELD);
 }
 
 void CPasswordInputField::onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) {
@@ -468,3 +464,8 @@ CBox CPasswordInputField::getBoundingBoxWl() const {
 void CPasswordInputField::onHover(const Vector2D& pos) {
     g_pSeatManager->m_pCursorShape->setShape(WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_TEXT);
 }
+
+void CPasswordInputField::onSuspend() {
+    shadow.release();
+    redrawShadow = true;
+}
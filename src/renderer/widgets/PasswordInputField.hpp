@@ -5,6 +5,7 @@
 #include "../../helpers/Color.hpp"
 #include "../../helpers/Math.hpp"
 #include "../../core/Timer.hpp"
+#include "../ResourceHandle.hpp"
 #include "Shadowable.hpp"
 #include "../../config/ConfigDataValues.hpp"
 #include "../../helpers/AnimatedVariable.hpp"
@@ -28,6 +29,7 @@ class CPasswordInputField : public IWidget {
 
     virtual void onHover(const Vector2D& pos);
     virtual CBox getBoundingBoxWl() const;
+    virtual void onSuspend();
 
     void         reset();
     void         onFadeOutTimer();
@@ -63,13 +65,13 @@ class CPasswordInputField : public IWidget {
 
     struct {
         PHLANIMVAR<float> currentAmount;
-        bool              center         = false;
-        float             size           = 0;
-        float             spacing        = 0;
-        int               rounding       = 0;
-        size_t            textResourceID = 0;
-        std::string       textFormat     = "";
-        ASP<CTexture>     textAsset      = nullptr;
+        bool              center     = false;
+        float             size       = 0;
+        float             spacing    = 0;
+        int               rounding   = 0;
+        std::string       textFormat = "";
+        ASP<CTexture>     textAsset  = nullptr;
+        CResourceHandle   textResource;
     } dots;
 
     struct {
@@ -80,11 +82,11 @@ class CPasswordInputField : public IWidget {
     } fade;
 
     struct {
-        size_t        resourceID = 0;
-        ASP<CTexture> asset      = nullptr;
+        CResourceHandle resource;
+        ASP<CTexture>   asset = nullptr;
 
-        std::string   currentText    = "";
-        size_t        failedAttempts = 0;
+        std::string     currentText    = "";
+        size_t          failedAttempts = 0;
     } placeholder;
 
     struct {
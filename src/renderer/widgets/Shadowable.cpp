@@ -37,6 +37,10 @@ void CShadowable::markShadowDirty() {
     g_pRenderer->popFb();
 }
 
+void CShadowable::release() {
+    shadowFB.destroyBuffer();
+}
+
 bool CShadowable::draw(const IWidget::SRenderData& data) {
     if (!m_widget || passes == 0)
         return true;
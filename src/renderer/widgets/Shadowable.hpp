@@ -18,6 +18,8 @@ class CShadowable {
     // instantly re-renders the shadow using the widget's draw() method
     void         markShadowDirty();
     virtual bool draw(const IWidget::SRenderData& data);
+    // Frees the shadow framebuffer. markShadowDirty() renders it again.
+    void release();
 
   private:
     AWP<IWidget> m_widget;
@@ -125,3 +125,9 @@ void CShape::onHover(const Vector2D& pos) {
     if (!onclickCommand.empty())
         g_pSeatManager->m_pCursorShape->setShape(WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_POINTER);
 }
+
+void CShape::onSuspend() {
+    shapeFB.destroyBuffer();
+    shadow.release();
+    firstRender = true;
+}
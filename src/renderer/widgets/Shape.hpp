@@ -23,6 +23,7 @@ class CShape : public IWidget {
     virtual CBox getBoundingBoxWl() const;
     virtual void onClick(uint32_t button, bool down, const Vector2D& pos);
     virtual void onHover(const Vector2D& pos);
+    virtual void onSuspend();
 
   private:
     AWP<CShape>        m_self;